@@ -0,0 +1,522 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2022, Daumantas Kavolis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <imgui_vulkan/imgui_vulkan.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+IMGUI_VK_MSVC_WARNING_DISABLE(4005)
+#include <imgui_impl_vulkan.h>
+IMGUI_VK_MSVC_WARNING_POP()
+
+#ifndef IMGUI_VK_BENCH_LIBRARY_VERSION
+#  define IMGUI_VK_BENCH_LIBRARY_VERSION "unknown"
+#endif
+
+IMGUI_VK_NAMESPACE_BEGIN
+
+/**
+ * @brief Base for benchmark scenarios, counts the geometry submitted every frame
+ */
+class BenchWindow : public Window {
+ public:
+  using Window::Window;
+
+  [[nodiscard]] auto vertices() const noexcept -> std::uint64_t { return vertices_; }
+  [[nodiscard]] auto indices() const noexcept -> std::uint64_t { return indices_; }
+  [[nodiscard]] auto captured_frames() const noexcept -> std::uint64_t { return captured_frames_; }
+
+ protected:
+  void before_render_frame(ImGui_ImplVulkanH_Window* wd [[maybe_unused]], ImDrawData* draw_data) override {
+    vertices_ += static_cast<std::uint64_t>(draw_data->TotalVtxCount);
+    indices_ += static_cast<std::uint64_t>(draw_data->TotalIdxCount);
+  }
+
+  void on_frame_captured(FrameCapture const& capture [[maybe_unused]]) override { ++captured_frames_; }
+
+ private:
+  std::uint64_t vertices_ = 0;
+  std::uint64_t indices_ = 0;
+  std::uint64_t captured_frames_ = 0;
+};
+
+/**
+ * @brief 100k row table scrolled every frame, only the visible rows are submitted through the clipper
+ */
+class HugeTable : public BenchWindow {
+ public:
+  using BenchWindow::BenchWindow;
+
+ protected:
+  void on_gui() override {
+    ImGuiViewport const* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(viewport->WorkPos);
+    ImGui::SetNextWindowSize(viewport->WorkSize);
+    ImGui::Begin("Huge table", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+
+    constexpr static int columns = 4;
+    if (ImGui::BeginTable("rows", columns, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+      ImGui::TableSetupColumn("index");
+      ImGui::TableSetupColumn("value");
+      ImGui::TableSetupColumn("square root");
+      ImGui::TableSetupColumn("label");
+      ImGui::TableHeadersRow();
+
+      ImGuiListClipper clipper;
+      clipper.Begin(rows);
+      while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::Text("%d", row);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.6f", static_cast<double>(std::sin(static_cast<float>(row))));
+          ImGui::TableNextColumn();
+          ImGui::Text("%.3f", std::sqrt(static_cast<double>(row)));
+          ImGui::TableNextColumn();
+          ImGui::Text("row #%08x", static_cast<unsigned>(row));
+        }
+      }
+
+      // jump around the table to defeat any row caching
+      scroll_ = std::fmod(scroll_ + 0.0137f, 1.0f);
+      ImGui::SetScrollY(scroll_ * ImGui::GetScrollMaxY());
+      ImGui::EndTable();
+    }
+    ImGui::End();
+  }
+
+ private:
+  constexpr static int rows = 100'000;
+  float scroll_ = 0;
+};
+
+/**
+ * @brief Dense line plots drawn straight into the window draw list, roughly a million vertices per frame
+ */
+class DensePlot : public BenchWindow {
+ public:
+  using BenchWindow::BenchWindow;
+
+ protected:
+  void on_gui() override {
+    ImGuiViewport const* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(viewport->WorkPos);
+    ImGui::SetNextWindowSize(viewport->WorkSize);
+    ImGui::Begin("Dense plot", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoSavedSettings);
+
+    ImVec2 const origin = ImGui::GetCursorScreenPos();
+    ImVec2 const size = ImGui::GetContentRegionAvail();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    // anti-aliased polylines generate ~4 vertices per point
+    points_.resize(points_per_series);
+    for (int series = 0; series < series_count; ++series) {
+      auto const phase = static_cast<float>(phase_) * 0.05f + static_cast<float>(series);
+      auto const baseline = size.y * (static_cast<float>(series) + 0.5f) / static_cast<float>(series_count);
+      for (std::size_t i = 0; i < points_.size(); ++i) {
+        auto const x = static_cast<float>(i) / static_cast<float>(points_.size() - 1);
+        points_[i] = ImVec2(origin.x + x * size.x, origin.y + baseline + 8.0f * std::sin(x * 200.0f + phase));
+      }
+      auto const color = IM_COL32(64 + 12 * series, 255 - 12 * series, 128, 255);
+      draw_list->AddPolyline(points_.data(), static_cast<int>(points_.size()), color, 0, 1.0f);
+    }
+    ImGui::Dummy(size);
+    ImGui::End();
+    ++phase_;
+  }
+
+ private:
+  constexpr static int series_count = 16;
+  constexpr static std::size_t points_per_series = 16'384;
+  std::vector<ImVec2> points_;
+  std::uint64_t phase_ = 0;
+};
+
+/**
+ * @brief Grid of many small windows with a handful of widgets each
+ */
+class ManyWindows : public BenchWindow {
+ public:
+  using BenchWindow::BenchWindow;
+
+ protected:
+  void on_gui() override {
+    ImGuiViewport const* viewport = ImGui::GetMainViewport();
+    ImVec2 const cell(viewport->WorkSize.x / static_cast<float>(grid), viewport->WorkSize.y / static_cast<float>(grid));
+
+    for (int i = 0; i < grid * grid; ++i) {
+      auto const column = static_cast<float>(i % grid);
+      auto const row = static_cast<float>(i / grid);
+      ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + column * cell.x, viewport->WorkPos.y + row * cell.y),
+                              ImGuiCond_Always);
+      ImGui::SetNextWindowSize(cell, ImGuiCond_Always);
+
+      auto const title = fmt::format("window {}", i);
+      ImGui::Begin(title.c_str(), nullptr, ImGuiWindowFlags_NoSavedSettings);
+      ImGui::Text("frame %llu", static_cast<unsigned long long>(frame_));
+      ImGui::SliderFloat("value", &values_[static_cast<std::size_t>(i)], 0.0f, 1.0f);
+      ImGui::Button("button");
+      ImGui::SameLine();
+      ImGui::Checkbox("flag", &flags_[static_cast<std::size_t>(i)]);
+      ImGui::End();
+    }
+    ++frame_;
+  }
+
+ private:
+  constexpr static int grid = 12;
+  std::array<float, grid * grid> values_{};
+  std::array<bool, grid * grid> flags_{};
+  std::uint64_t frame_ = 0;
+};
+
+/**
+ * @brief Display size changing every frame, forcing the layout of stretched windows and tables to be redone
+ *
+ * The offscreen targets keep their size in headless mode so this measures relayout rather than swapchain recreation.
+ */
+class FrequentResize : public BenchWindow {
+ public:
+  using BenchWindow::BenchWindow;
+
+ protected:
+  void on_synthetic_input(ImGuiIO& io, std::uint64_t frame) override {
+    // oscillate between half and full size
+    auto const scale = 0.75f + 0.25f * std::sin(static_cast<float>(frame) * 0.3f);
+    io.DisplaySize = ImVec2(io.DisplaySize.x * scale, io.DisplaySize.y * scale);
+    BenchWindow::on_synthetic_input(io, frame);
+  }
+
+  void on_gui() override {
+    ImGuiViewport const* viewport = ImGui::GetMainViewport();
+    ImVec2 const half(viewport->WorkSize.x * 0.5f, viewport->WorkSize.y);
+
+    ImGui::SetNextWindowPos(viewport->WorkPos, ImGuiCond_Always);
+    ImGui::SetNextWindowSize(half, ImGuiCond_Always);
+    ImGui::Begin("Text", nullptr, ImGuiWindowFlags_NoSavedSettings);
+    for (int i = 0; i < 32; ++i) {
+      ImGui::TextWrapped(
+          "Wrapped paragraph %d is laid out again whenever the window width changes, which happens every frame here.",
+          i);
+    }
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + half.x, viewport->WorkPos.y), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(half, ImGuiCond_Always);
+    ImGui::Begin("Table", nullptr, ImGuiWindowFlags_NoSavedSettings);
+    if (ImGui::BeginTable("stretched", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+      for (int row = 0; row < 64; ++row) {
+        ImGui::TableNextRow();
+        for (int column = 0; column < 6; ++column) {
+          ImGui::TableNextColumn();
+          ImGui::Text("%d:%d", row, column);
+        }
+      }
+      ImGui::EndTable();
+    }
+    ImGui::End();
+  }
+};
+
+/**
+ * @brief Font atlas rasterized from scratch at a different size every few frames
+ *
+ * The atlas in use by the renderer is rebuilt and uploaded again, so this measures a whole rebuild: glyph
+ * rasterization, packing and the upload of the new atlas texture.
+ */
+class FontRebuild : public BenchWindow {
+ public:
+  using BenchWindow::BenchWindow;
+
+ protected:
+  void on_gui() override {
+    // rebuilt and uploaded through the staging ring before the next frame
+    if (frame_ % rebuild_interval == 0) rebuild_fonts();
+
+    ImGui::Begin("Font atlas", nullptr, ImGuiWindowFlags_NoSavedSettings);
+    ImGui::Text("font size %.0f", static_cast<double>(font_size_));
+    ImGui::End();
+    ++frame_;
+  }
+
+  void on_load_fonts(ImFontAtlas& fonts) override {
+    ImFontConfig config;
+    config.SizePixels = font_size_ = 13.0f + static_cast<float>((frame_ / rebuild_interval) % 8) * 2.0f;
+    fonts.AddFontDefault(&config);
+  }
+
+ private:
+  constexpr static std::uint64_t rebuild_interval = 4;
+  std::uint64_t frame_ = 0;
+  float font_size_ = 0;
+};
+
+IMGUI_VK_NAMESPACE_END
+
+namespace {
+
+struct Scenario {
+  std::string_view name;
+  std::function<std::unique_ptr<imgui_vulkan::BenchWindow>(int width, int height)> create;
+};
+
+template <class T>
+auto make_scenario(std::string_view name) -> Scenario {
+  return {name, [name](int width, int height) { return std::make_unique<T>(std::string(name), width, height); }};
+}
+
+struct Options {
+  imgui_vulkan::HeadlessOptions headless{.frames = 500, .width = 1920, .height = 1080};
+  std::uint32_t frames_in_flight = 2;
+  bool threaded_rendering = false;
+  bool host_allocator = false;
+  bool skip_unchanged = false;
+  bool device_local_geometry = false;
+  imgui_vulkan::ParallelRecording parallel_recording;
+  std::uint32_t msaa_samples = 1;
+  bool frame_capture = false;
+  imgui_vulkan::RenderScalePolicy render_scale;
+  std::string gpu;
+  std::string scenario;
+  std::string output;
+  std::string trace;
+};
+
+void print_usage(char const* program) {
+  fmt::print(stderr,
+             "usage: {} [--frames N] [--width W] [--height H] [--images N] [--frames-in-flight N] [--threaded 0|1] "
+             "[--host-allocator 0|1] [--skip-unchanged 0|1] [--device-local-geometry 0|1] [--recording-threads N] "
+             "[--parallel-min-vertices N] [--msaa N] [--capture 0|1] [--render-scale S] [--target-fps F] "
+             "[--gpu INDEX|UUID|NAME] [--scenario NAME] [--output FILE] [--trace FILE]\n",
+             program);
+}
+
+auto parse_options(int argc, char* argv[]) -> std::optional<Options> {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view const arg = argv[i];
+    if (i + 1 >= argc) return std::nullopt;
+    char const* value = argv[++i];
+
+    if (arg == "--frames") {
+      options.headless.frames = std::strtoull(value, nullptr, 10);
+    } else if (arg == "--width") {
+      options.headless.width = std::atoi(value);
+    } else if (arg == "--height") {
+      options.headless.height = std::atoi(value);
+    } else if (arg == "--images") {
+      options.headless.image_count = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--frames-in-flight") {
+      options.frames_in_flight = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--threaded") {
+      options.threaded_rendering = std::atoi(value) != 0;
+    } else if (arg == "--host-allocator") {
+      options.host_allocator = std::atoi(value) != 0;
+    } else if (arg == "--skip-unchanged") {
+      options.skip_unchanged = std::atoi(value) != 0;
+    } else if (arg == "--device-local-geometry") {
+      options.device_local_geometry = std::atoi(value) != 0;
+    } else if (arg == "--recording-threads") {
+      options.parallel_recording.threads = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--parallel-min-vertices") {
+      options.parallel_recording.min_vertices = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--msaa") {
+      options.msaa_samples = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--capture") {
+      options.frame_capture = std::atoi(value) != 0;
+    } else if (arg == "--render-scale") {
+      options.render_scale.scale = std::strtof(value, nullptr);
+    } else if (arg == "--target-fps") {
+      options.render_scale.target_fps = std::strtof(value, nullptr);
+    } else if (arg == "--gpu") {
+      options.gpu = value;
+    } else if (arg == "--scenario") {
+      options.scenario = value;
+    } else if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--trace") {
+      options.trace = value;
+    } else {
+      return std::nullopt;
+    }
+  }
+  return options;
+}
+
+// nearest rank percentile over sorted samples
+auto percentile(std::span<float const> sorted, float p) -> float {
+  if (sorted.empty()) return 0;
+  auto const rank = static_cast<std::size_t>(std::ceil(p * static_cast<float>(sorted.size())));
+  return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void append_distribution(fmt::memory_buffer& out, std::vector<float> samples) {
+  std::ranges::sort(samples);
+  fmt::format_to(std::back_inserter(out), R"({{"p50": {}, "p90": {}, "p99": {}, "max": {}}})",
+                 percentile(samples, 0.50f), percentile(samples, 0.90f), percentile(samples, 0.99f),
+                 samples.empty() ? 0.0f : samples.back());
+}
+
+void append_summary(fmt::memory_buffer& out, imgui_vulkan::TimingSummary const& summary) {
+  fmt::format_to(std::back_inserter(out), R"({{"min": {}, "avg": {}, "p99": {}, "max": {}}})", summary.min,
+                 summary.avg, summary.p99, summary.max);
+}
+
+void run_scenario(fmt::memory_buffer& out, Scenario const& scenario, Options const& options) {
+  auto window = scenario.create(options.headless.width, options.headless.height);
+  window->set_frames_in_flight(options.frames_in_flight);
+  window->set_threaded_rendering(options.threaded_rendering);
+  window->set_host_allocator({.enable = options.host_allocator});
+  window->set_skip_unchanged_frames(options.skip_unchanged);
+  window->set_device_local_geometry(options.device_local_geometry);
+  window->set_parallel_recording(options.parallel_recording);
+  window->set_msaa_samples(options.msaa_samples);
+  window->set_frame_capture(options.frame_capture);
+  window->set_render_scale_policy(options.render_scale);
+  window->set_gpu_selection({.device = options.gpu});
+  auto const report = window->run_headless(options.headless);
+
+  std::vector<imgui_vulkan::FrameTimings> timings(imgui_vulkan::Window::frame_history_size);
+  timings.resize(window->frame_timings(timings));
+  std::vector<float> cpu;
+  std::vector<float> gpu;
+  for (auto const& frame : timings) {
+    cpu.push_back(frame.cpu_total);
+    gpu.push_back(frame.gpu);
+  }
+
+  auto const frames = std::max<std::uint64_t>(report.frames, 1);
+  auto inserter = std::back_inserter(out);
+  fmt::format_to(inserter,
+                 R"({{"name": "{}", "device": "{}", "frames": {}, "skipped_frames": {}, "seconds": {}, "fps": {}, )"
+                 R"("vertices_per_frame": {}, "indices_per_frame": {}, "samples": {}, "cpu_ms": )",
+                 scenario.name, window->device_info().name, report.frames, window->skipped_frames(), report.seconds,
+                 report.fps, window->vertices() / frames, window->indices() / frames, timings.size());
+  append_distribution(out, std::move(cpu));
+  fmt::format_to(inserter, R"(, "gpu_ms": )");
+  append_distribution(out, std::move(gpu));
+  fmt::format_to(inserter, R"(, "phases_ms": {{)");
+  for (std::size_t i = 0; i < imgui_vulkan::frame_phase_count; ++i) {
+    fmt::format_to(inserter, R"({}"{}": )", i == 0 ? "" : ", ",
+                   imgui_vulkan::frame_phase_name(static_cast<imgui_vulkan::FramePhase>(i)));
+    append_summary(out, report.stats.cpu[i]);
+  }
+  fmt::format_to(inserter, R"(}}, "descriptors": {{"pools": {}, "capacity": {}, "peak": {}}})",
+                 report.descriptors.pools, report.descriptors.capacity, report.descriptors.peak);
+  auto const startup = window->startup_timings();
+  fmt::format_to(inserter,
+                 R"(, "startup_ms": {{"device": {}, "swap_chain": {}, "imgui": {}, "fonts": {}, "pipeline": {}, )"
+                 R"("first_frame": {}}})",
+                 startup.device, startup.swap_chain, startup.imgui, startup.fonts, startup.pipeline,
+                 startup.first_frame);
+  if (options.frame_capture) fmt::format_to(inserter, R"(, "captured_frames": {})", window->captured_frames());
+  // the scale the adaptive mode settled on
+  fmt::format_to(inserter, R"(, "render_scale": {})", window->render_scale());
+
+  if (options.host_allocator) {
+    auto const memory = window->host_memory_stats();
+    fmt::format_to(inserter,
+                   R"(, "host_memory": {{"bytes_peak": {}, "bytes_reserved": {}, "bytes_internal": {}, )"
+                   R"("allocations": {}, "allocations_per_frame": {}, "arena_allocations": {}}})",
+                   memory.bytes_peak, memory.bytes_reserved, memory.bytes_internal, memory.allocations,
+                   memory.allocations_last_frame, memory.arena_allocations);
+  }
+  fmt::format_to(inserter, "}}");
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  auto const options = parse_options(argc, argv);
+  if (!options) {
+    print_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::array const scenarios{
+      make_scenario<imgui_vulkan::HugeTable>("huge_table"),
+      make_scenario<imgui_vulkan::DensePlot>("dense_plot"),
+      make_scenario<imgui_vulkan::ManyWindows>("many_windows"),
+      make_scenario<imgui_vulkan::FrequentResize>("frequent_resize"),
+      make_scenario<imgui_vulkan::FontRebuild>("font_rebuild"),
+  };
+
+  fmt::memory_buffer out;
+  fmt::format_to(std::back_inserter(out),
+                 R"({{"library_version": "{}", "width": {}, "height": {}, "image_count": {}, "frames_in_flight": {}, )"
+                 R"("threaded_rendering": {}, "device_local_geometry": {}, "recording_threads": {}, )"
+                 R"("msaa_samples": {}, "frame_capture": {}, "render_scale": {}, "target_fps": {}, "scenarios": [)",
+                 IMGUI_VK_BENCH_LIBRARY_VERSION, options->headless.width, options->headless.height,
+                 options->headless.image_count, options->frames_in_flight, options->threaded_rendering,
+                 options->device_local_geometry, options->parallel_recording.threads,
+                 options->msaa_samples, options->frame_capture, options->render_scale.scale,
+                 options->render_scale.target_fps);
+
+  bool first = true;
+  if (!options->trace.empty()) imgui_vulkan::start_tracing();
+  try {
+    for (auto const& scenario : scenarios) {
+      if (!options->scenario.empty() && scenario.name != options->scenario) continue;
+      if (!first) fmt::format_to(std::back_inserter(out), ", ");
+      first = false;
+      fmt::print(stderr, "running {}...\n", scenario.name);
+      imgui_vulkan::TraceZone zone(scenario.name);
+      run_scenario(out, scenario, *options);
+    }
+    if (!options->trace.empty()) imgui_vulkan::stop_tracing(options->trace);
+  } catch (imgui_vulkan::GUIError const& e) {
+    fmt::print(stderr, "{}\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  if (first) {
+    fmt::print(stderr, "unknown scenario '{}'\n", options->scenario);
+    return EXIT_FAILURE;
+  }
+  fmt::format_to(std::back_inserter(out), "]}}\n");
+
+  if (options->output.empty()) {
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return EXIT_SUCCESS;
+  }
+
+  std::FILE* file = std::fopen(options->output.c_str(), "wb");
+  if (file == nullptr) {
+    fmt::print(stderr, "could not open '{}' for writing\n", options->output);
+    return EXIT_FAILURE;
+  }
+  std::fwrite(out.data(), 1, out.size(), file);
+  std::fclose(file);
+  return EXIT_SUCCESS;
+}
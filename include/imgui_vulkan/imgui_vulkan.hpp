@@ -1,208 +1,1268 @@
-/**
- * MIT License
- *
- * Copyright (c) 2022, Daumantas Kavolis
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#pragma once
-
-#include <array>
-#include <cstdint>
-#include <memory>
-#include <numeric>
-#include <source_location>
-#include <span>
-#include <stdexcept>
-#include <string>
-
-#define IMGUI_VK_DO_PRAGMA(x) _Pragma(#x)
-#if defined(__GNUC__) && !defined(__clang__)
-#  define IMGUI_VK_GCC_DIAGNOSTIC_IGNORED(wrn) \
-    IMGUI_VK_DO_PRAGMA(GCC diagnostic push)    \
-    IMGUI_VK_DO_PRAGMA(GCC diagnostic ignored wrn)
-#  define IMGUI_VK_GCC_DIAGNOSTIC_POP() IMGUI_VK_DO_PRAGMA(GCC diagnostic pop)
-#else
-#  define IMGUI_VK_GCC_DIAGNOSTIC_IGNORED(wrn)
-#  define IMGUI_VK_GCC_DIAGNOSTIC_POP()
-#endif
-
-#if defined(__clang__)
-#  define IMGUI_VK_CLANG_DIAGNOSTIC_IGNORED(wrn) \
-    IMGUI_VK_DO_PRAGMA(clang diagnostic push)    \
-    IMGUI_VK_DO_PRAGMA(clang diagnostic ignored wrn)
-#  define IMGUI_VK_CLANG_DIAGNOSTIC_POP() IMGUI_VK_DO_PRAGMA(clang diagnostic pop)
-#else
-#  define IMGUI_VK_CLANG_DIAGNOSTIC_IGNORED(wrn)
-#  define IMGUI_VK_CLANG_DIAGNOSTIC_POP()
-#endif
-
-#if defined(_MSC_VER)
-#  define IMGUI_VK_MSVC_WARNING_DISABLE(wrn) __pragma(warning(push)) __pragma(warning(disable : wrn))
-#  define IMGUI_VK_MSVC_WARNING_POP() __pragma(warning(pop))
-#else
-#  define IMGUI_VK_MSVC_WARNING_DISABLE(wrn)
-#  define IMGUI_VK_MSVC_WARNING_POP()
-#endif
-
-// installing imgui through vcpkg with vulkan/sdl2 will also add the macros to command line and imconfig.h...
-IMGUI_VK_MSVC_WARNING_DISABLE(4005)
-#include <imgui.h>
-IMGUI_VK_MSVC_WARNING_POP()
-
-struct SDL_Window;
-struct ImGui_ImplVulkanH_Window;
-
-#define IMGUI_VK_NAMESPACE_BEGIN \
-  namespace imgui_vulkan {       \
-  inline namespace v0 {
-#define IMGUI_VK_NAMESPACE_END \
-  } /* namespace v0 */         \
-  } /* namespace imgui_vulkan */
-
-IMGUI_VK_NAMESPACE_BEGIN
-
-class GUIError : public std::runtime_error {
- public:
-  explicit GUIError(std::string const& msg, int code = -1, std::source_location src = std::source_location::current())
-      : std::runtime_error(msg), src_(src), error_(code) {}
-  explicit GUIError(char const* msg, int code = -1, std::source_location src = std::source_location::current())
-      : std::runtime_error(msg), src_(src), error_(code) {}
-
-  [[nodiscard]] auto error() const noexcept -> int;
-
-  [[nodiscard]] auto source() const noexcept -> std::source_location;
-
- private:
-  std::source_location src_;
-  int error_ = -1;
-};
-
-class Vulkan;
-class Window;
-
-/**
- * @brief SDL2 GUI application.
- *
- */
-class Application {
- public:
-  /**
-   * @brief Construct a new Application object with main window. Sets up SDL2 environment
-   *
-   * @param window main window
-   */
-  Application(Window* window);
-
-  /**
-   * @brief Destroy the Application object. Cleans up SDL2 environment.
-   */
-  ~Application() noexcept;
-
-  /**
-   * @brief Display the main window. Caught exceptions are printed to stderr.
-   *
-   * @return int Exit code
-   */
-  auto run() noexcept -> int;
-
- private:
-  Window* window_;
-};
-
-/**
- * @brief Vulkan/SDL2 ImGui window. Pass to `Application` to run.
- *
- */
-class Window {
- public:
-  /**
-   * @brief Construct a new Window object
-   *
-   * @param name Window name
-   * @param width Window width in pixels
-   * @param height Window height in pixels
-   */
-  Window(std::string name, int width, int height) noexcept;
-
-  virtual ~Window() noexcept;
-
-  /**
-   * @brief Close the window
-   */
-  void close() noexcept;
-
-  [[nodiscard]] auto name() const noexcept -> std::string_view;
-  [[nodiscard]] auto is_running() const noexcept -> bool;
-  [[nodiscard]] auto width() const noexcept -> int;
-  [[nodiscard]] auto height() const noexcept -> int;
-
- protected:
-  /**
-   * @brief Main entry point for ImGui implementation, everything is setup by this point. Called once per draw loop
-   */
-  virtual void on_gui() = 0;
-
-  /**
-   * @brief Change window parameters before rendering, called every loop just before rendering the frame in Vulkan and
-   * after the draw data has been prepared. Requires `#include <imgui_impl_vulkan.h>`
-   *
-   * @param wd Vulkan window parameters
-   * @param draw_data ImGui draw data
-   */
-  virtual void before_render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data);
-
- private:
-  std::string name_;
-  std::array<int, 2> size_;
-  bool running_ = false;
-  // noop deleter, cleaned up after the window is closed
-  SDL_Window* window_ = nullptr;
-  // PIMPL for all Vulkan related stuff, cleaned up with the window
-  std::unique_ptr<Vulkan> vulkan_ = nullptr;
-
-  friend class Application;
-
-  /**
-   * @brief Draw GUI once, called in show() loop
-   */
-  void draw();
-
-  /**
-   * @brief Display the window, blocks until the window is closed
-   */
-  void show();
-};
-
-inline void Window::close() noexcept { running_ = false; }
-
-[[nodiscard]] inline auto Window::name() const noexcept -> std::string_view { return name_; }
-
-[[nodiscard]] inline auto Window::is_running() const noexcept -> bool { return running_; }
-
-[[nodiscard]] inline auto Window::width() const noexcept -> int { return size_[0]; }
-
-[[nodiscard]] inline auto Window::height() const noexcept -> int { return size_[1]; }
-
-[[nodiscard]] inline auto GUIError::error() const noexcept -> int { return error_; }
-
-[[nodiscard]] inline auto GUIError::source() const noexcept -> std::source_location { return src_; }
-
-IMGUI_VK_NAMESPACE_END
+/**
+ * MIT License
+ *
+ * Copyright (c) 2022, Daumantas Kavolis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <source_location>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#define IMGUI_VK_DO_PRAGMA(x) _Pragma(#x)
+#if defined(__GNUC__) && !defined(__clang__)
+#  define IMGUI_VK_GCC_DIAGNOSTIC_IGNORED(wrn) \
+    IMGUI_VK_DO_PRAGMA(GCC diagnostic push)    \
+    IMGUI_VK_DO_PRAGMA(GCC diagnostic ignored wrn)
+#  define IMGUI_VK_GCC_DIAGNOSTIC_POP() IMGUI_VK_DO_PRAGMA(GCC diagnostic pop)
+#else
+#  define IMGUI_VK_GCC_DIAGNOSTIC_IGNORED(wrn)
+#  define IMGUI_VK_GCC_DIAGNOSTIC_POP()
+#endif
+
+#if defined(__clang__)
+#  define IMGUI_VK_CLANG_DIAGNOSTIC_IGNORED(wrn) \
+    IMGUI_VK_DO_PRAGMA(clang diagnostic push)    \
+    IMGUI_VK_DO_PRAGMA(clang diagnostic ignored wrn)
+#  define IMGUI_VK_CLANG_DIAGNOSTIC_POP() IMGUI_VK_DO_PRAGMA(clang diagnostic pop)
+#else
+#  define IMGUI_VK_CLANG_DIAGNOSTIC_IGNORED(wrn)
+#  define IMGUI_VK_CLANG_DIAGNOSTIC_POP()
+#endif
+
+#if defined(_MSC_VER)
+#  define IMGUI_VK_MSVC_WARNING_DISABLE(wrn) __pragma(warning(push)) __pragma(warning(disable : wrn))
+#  define IMGUI_VK_MSVC_WARNING_POP() __pragma(warning(pop))
+#else
+#  define IMGUI_VK_MSVC_WARNING_DISABLE(wrn)
+#  define IMGUI_VK_MSVC_WARNING_POP()
+#endif
+
+// installing imgui through vcpkg with vulkan/sdl2 will also add the macros to command line and imconfig.h...
+IMGUI_VK_MSVC_WARNING_DISABLE(4005)
+#include <imgui.h>
+IMGUI_VK_MSVC_WARNING_POP()
+
+struct SDL_Window;
+union SDL_Event;
+struct ImGui_ImplVulkanH_Window;
+struct VkAllocationCallbacks;
+
+#define IMGUI_VK_NAMESPACE_BEGIN \
+  namespace imgui_vulkan {       \
+  inline namespace v0 {
+#define IMGUI_VK_NAMESPACE_END \
+  } /* namespace v0 */         \
+  } /* namespace imgui_vulkan */
+
+IMGUI_VK_NAMESPACE_BEGIN
+
+class GUIError : public std::runtime_error {
+ public:
+  explicit GUIError(std::string const& msg, int code = -1, std::source_location src = std::source_location::current())
+      : std::runtime_error(msg), src_(src), error_(code) {}
+  explicit GUIError(char const* msg, int code = -1, std::source_location src = std::source_location::current())
+      : std::runtime_error(msg), src_(src), error_(code) {}
+
+  [[nodiscard]] auto error() const noexcept -> int;
+
+  [[nodiscard]] auto source() const noexcept -> std::source_location;
+
+ private:
+  std::source_location src_;
+  int error_ = -1;
+};
+
+class Device;
+class Vulkan;
+class Window;
+class PhaseTimer;
+class RenderThread;
+class HostAllocator;
+
+/**
+ * @brief Swapchain presentation mode. Falls back to `fifo` if the surface does not support the requested mode.
+ */
+enum class PresentMode {
+  // VSync, lowest power usage
+  fifo,
+  // VSync, late frames are presented immediately and may tear
+  fifo_relaxed,
+  // Low latency without tearing, renders as fast as possible
+  mailbox,
+  // No VSync, may tear, for benchmarking
+  immediate,
+};
+
+// Build configuration, the definitions have to be the same for the library and everything including this header so
+// they are set through CMake options (imgui_vulkan_VALIDATION, ...) as public compile definitions
+#ifndef IMGUI_VK_VALIDATION
+#  if defined(_DEBUG) || defined(IMGUI_VK_DEBUG_REPORT)
+#    define IMGUI_VK_VALIDATION 1
+#  else
+#    define IMGUI_VK_VALIDATION 0
+#  endif
+#endif
+#ifndef IMGUI_VK_INSTRUMENTATION
+#  define IMGUI_VK_INSTRUMENTATION 1
+#endif
+#ifndef IMGUI_VK_THREADED_RENDERING
+#  define IMGUI_VK_THREADED_RENDERING 1
+#endif
+#ifndef IMGUI_VK_FRAMES_IN_FLIGHT
+#  define IMGUI_VK_FRAMES_IN_FLIGHT 2
+#endif
+#ifndef IMGUI_VK_TRACING
+#  define IMGUI_VK_TRACING 0
+#endif
+
+/**
+ * @brief Compile time options of the library. Disabled features are removed from the frame loop with `if constexpr`
+ * instead of being checked on every frame, so e.g. a release build without instrumentation never reads the clock
+ */
+struct Config {
+  // Vulkan validation layers and debug report callback, also reports positive VkResult codes
+  bool validation;
+  // CPU phase timers and GPU timestamp queries, `Window::frame_stats` is all zeros without them
+  bool instrumentation;
+  // render thread support, `Window::set_threaded_rendering` has no effect without it
+  bool threaded_rendering;
+  // default of `Window::set_frames_in_flight`
+  std::uint32_t frames_in_flight;
+  // default present mode of `Window::set_present_policy`
+  PresentMode present_mode;
+  // `TraceZone` recording and GPU timestamp zones, `start_tracing` has no effect without it
+  bool tracing;
+};
+
+inline constexpr Config build_config{
+    .validation = IMGUI_VK_VALIDATION != 0,
+    .instrumentation = IMGUI_VK_INSTRUMENTATION != 0,
+    .threaded_rendering = IMGUI_VK_THREADED_RENDERING != 0,
+    .frames_in_flight = IMGUI_VK_FRAMES_IN_FLIGHT,
+#ifdef IMGUI_UNLIMITED_FRAME_RATE
+    .present_mode = PresentMode::mailbox,
+#else
+    .present_mode = PresentMode::fifo,
+#endif
+    .tracing = IMGUI_VK_TRACING != 0,
+};
+static_assert(build_config.frames_in_flight > 0, "IMGUI_VK_FRAMES_IN_FLIGHT has to be at least 1");
+
+/**
+ * @brief Fixed size ring buffer with a single lock-free writer and any number of lock-free readers. Each slot is
+ * guarded by a sequence counter derived from the write index so readers can detect and skip values that were
+ * overwritten while being copied.
+ *
+ * @tparam T trivially copyable value type
+ * @tparam N capacity, power of 2
+ */
+template <class T, std::size_t N>
+class RingBuffer {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(std::has_single_bit(N), "Capacity must be a power of 2");
+
+ public:
+  using value_type = T;
+
+  /**
+   * @brief Append a value, overwriting the oldest one if full. Must only be called from a single thread
+   */
+  void push(T const& value) noexcept;
+
+  /**
+   * @brief Copy the most recent values, oldest first. Safe to call from any thread
+   *
+   * @param out Destination, at most `out.size()` values are copied
+   * @return std::size_t Number of values copied
+   */
+  [[nodiscard]] auto copy_latest(std::span<T> out) const noexcept -> std::size_t;
+
+  /**
+   * @brief Total number of values pushed so far
+   */
+  [[nodiscard]] auto pushed() const noexcept -> std::uint64_t;
+
+  [[nodiscard]] constexpr static auto capacity() noexcept -> std::size_t { return N; }
+
+ private:
+  constexpr static std::size_t words = (sizeof(T) + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t);
+
+  struct Slot {
+    // 2 * index + 1 while value at index is being written, 2 * index + 2 once written
+    std::atomic<std::uint64_t> sequence = 0;
+    std::array<std::atomic<std::uint32_t>, words> data{};
+  };
+
+  std::array<Slot, N> slots_{};
+  std::atomic<std::uint64_t> head_ = 0;
+};
+
+/**
+ * @brief CPU side phases of a frame
+ */
+enum class FramePhase : std::uint8_t {
+  // SDL event polling, excluding power saving waits
+  poll_events,
+  // swap chain resize and ImGui new frame
+  new_frame,
+  on_gui,
+  // ImGui::Render
+  render,
+  // copying draw data for the render thread, including waiting for a free buffer
+  snapshot,
+  before_render_frame,
+  // waiting for the GPU to finish with the frame in flight resources
+  fence_wait,
+  // vkAcquireNextImageKHR
+  acquire,
+  // command buffer recording
+  record,
+  submit,
+  present,
+  count,
+};
+
+constexpr static std::size_t frame_phase_count = static_cast<std::size_t>(FramePhase::count);
+
+[[nodiscard]] constexpr auto frame_phase_name(FramePhase phase) noexcept -> std::string_view {
+  constexpr std::array<std::string_view, frame_phase_count> names{
+      "poll events", "new frame", "on_gui", "render",  "snapshot", "before render frame",
+      "fence wait",  "acquire",   "record", "submit",  "present",
+  };
+  return phase < FramePhase::count ? names[static_cast<std::size_t>(phase)] : "unknown";
+}
+
+/**
+ * @brief Timings of a single frame in milliseconds
+ */
+struct FrameTimings {
+  std::array<float, frame_phase_count> cpu{};
+  // CPU time of the whole frame, excluding power saving waits and the frame limiter
+  float cpu_total = 0;
+  // GPU time of the most recently completed ImGui draw commands, 0 if timestamps are not available
+  float gpu = 0;
+  // from the SDL timestamp of the oldest input event the frame handled to the return of its present, 0 without input
+  float input_latency = 0;
+  // resolution of the main window relative to its size, see `Window::set_render_scale_policy`
+  float render_scale = 1;
+  std::uint64_t frame = 0;
+};
+
+// upper bounds in milliseconds of the input latency histogram buckets, one more bucket counts everything above
+inline constexpr std::array<float, 9> input_latency_buckets{4, 8, 12, 16, 25, 33, 50, 100, 200};
+
+/**
+ * @brief Summary of timings over multiple frames in milliseconds
+ */
+struct TimingSummary {
+  float min = 0;
+  float avg = 0;
+  float p99 = 0;
+  float max = 0;
+};
+
+/**
+ * @brief Frame timing statistics over the most recent frames
+ */
+struct FrameStats {
+  // number of frames the statistics were computed over
+  std::size_t frames = 0;
+  std::array<TimingSummary, frame_phase_count> cpu{};
+  TimingSummary cpu_total;
+  TimingSummary gpu;
+  // frames that handled input, the input latency is only summarized over those
+  std::size_t input_frames = 0;
+  TimingSummary input_latency;
+  std::array<std::uint32_t, input_latency_buckets.size() + 1> input_latency_histogram{};
+};
+
+/**
+ * @brief Scoped CPU zone of the trace recorded between `start_tracing` and `stop_tracing`. The library traces the frame
+ * loop with these, applications can add their own to see them on the same timeline. Compiles to nothing without
+ * `IMGUI_VK_TRACING`
+ */
+class TraceZone {
+ public:
+  // the name is referenced until the trace is written, e.g. a string literal
+  explicit TraceZone(std::string_view name) noexcept : name_(name) {
+    if constexpr (build_config.tracing) begin_ = begin();
+  }
+  ~TraceZone() noexcept {
+    if constexpr (build_config.tracing) end(name_, begin_);
+  }
+
+  TraceZone(TraceZone const&) = delete;
+  auto operator=(TraceZone const&) -> TraceZone& = delete;
+
+ private:
+  std::string_view name_;
+  // steady clock nanoseconds, negative if tracing was stopped when the zone was entered
+  std::int64_t begin_ = -1;
+
+  [[nodiscard]] static auto begin() noexcept -> std::int64_t;
+  static void end(std::string_view name, std::int64_t begin) noexcept;
+};
+
+/**
+ * @brief Start recording trace zones of all threads, discarding any previous recording. Each thread appends to its own
+ * buffer without locking, zones beyond its capacity are dropped. Does nothing without `IMGUI_VK_TRACING`
+ */
+void start_tracing() noexcept;
+
+/**
+ * @brief Stop recording and write the trace as Chrome trace event JSON, viewable in Perfetto or chrome://tracing and
+ * convertible with Tracy's import-chrome. Timestamps are microseconds of `std::chrono::steady_clock` since its epoch
+ * so other traces using the same clock line up. Writes an empty trace without `IMGUI_VK_TRACING`
+ *
+ * @param path output file
+ * @throws GUIError if the file can't be written
+ */
+void stop_tracing(std::filesystem::path const& path);
+
+/**
+ * @brief Options for rendering a window offscreen without an SDL window or swap chain
+ */
+struct HeadlessOptions {
+  // number of frames to render
+  std::uint64_t frames = 1000;
+  // render target size in pixels, 0 to use the window size
+  int width = 0;
+  int height = 0;
+  // number of offscreen images rendered into round robin, at least the number of frames in flight
+  std::uint32_t image_count = 3;
+  // simulated time between frames in seconds passed to ImGui
+  float delta_time = 1.0f / 60.0f;
+  // whether to call `Window::on_synthetic_input` every frame
+  bool synthetic_input = true;
+};
+
+/**
+ * @brief Counters of the texture descriptor set allocator shared by all windows using the same device
+ */
+struct DescriptorStats {
+  // pools are chained, each one twice as large as the previous one up to a limit
+  std::uint32_t pools = 0;
+  // descriptor sets that fit into all pools
+  std::uint32_t capacity = 0;
+  std::uint32_t live = 0;
+  std::uint32_t peak = 0;
+  // freed sets kept for reuse by the next textures
+  std::uint32_t recycled = 0;
+};
+
+/**
+ * @brief Durations of the steps of showing a window in milliseconds. The pipeline is built on a worker thread while the
+ * other steps run
+ */
+struct StartupTimings {
+  // SDL window creation
+  float window = 0;
+  // Vulkan instance, device and pipeline cache, only the window creating the shared device spends time on them
+  float device = 0;
+  // surface, swap chain or offscreen targets, frames in flight and staging rings
+  float swap_chain = 0;
+  // ImGui context and backends
+  float imgui = 0;
+  // `Window::on_load_fonts` and rasterizing the atlas, while the pipeline is built
+  float fonts = 0;
+  // shader modules and graphics pipeline on a worker thread
+  float pipeline = 0;
+  // until the first frame ended, 0 before that
+  float first_frame = 0;
+};
+
+/**
+ * @brief Results of a headless run
+ */
+struct HeadlessReport {
+  std::uint64_t frames = 0;
+  // wall time of the whole run including waiting for the GPU to finish
+  double seconds = 0;
+  double fps = 0;
+  // statistics over the rendered frames, limited by `Window::frame_history_size`
+  FrameStats stats;
+  DescriptorStats descriptors;
+};
+
+/**
+ * @brief Channel order of captured pixels, 8 bits per channel
+ */
+enum class PixelFormat : std::uint8_t {
+  rgba8,
+  bgra8,
+  rgb8,
+  bgr8,
+};
+
+/**
+ * @brief Image of a rendered frame copied back from the GPU, see `Window::set_frame_capture`
+ */
+struct FrameCapture {
+  // frame number on the GPU timeline of the window, the frame's submission signaled it with frame + 1
+  std::uint64_t frame = 0;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  PixelFormat format = PixelFormat::rgba8;
+  // tightly packed rows from the top, only valid during `Window::on_frame_captured`
+  std::span<std::byte const> pixels;
+};
+
+/**
+ * @brief Options of the built-in Vulkan host memory allocator
+ */
+struct HostAllocatorOptions {
+  bool enable = false;
+  // bump arena for command scope allocations, reset whenever all of them have been freed. 0 to disable
+  std::size_t arena_size = 256 * 1024;
+  // allocations beyond this many live bytes fail with VK_ERROR_OUT_OF_HOST_MEMORY, 0 for no limit
+  std::size_t max_bytes = 0;
+};
+
+/**
+ * @brief Counters of the built-in Vulkan host memory allocator
+ */
+struct HostMemoryStats {
+  // bytes requested by the driver that have not been freed yet
+  std::size_t bytes_live = 0;
+  std::size_t bytes_peak = 0;
+  // bytes reserved from the system by the pools, the arena and large allocations
+  std::size_t bytes_reserved = 0;
+  // bytes the driver reported allocating on its own, e.g. executable memory
+  std::size_t bytes_internal = 0;
+  std::uint64_t allocations = 0;
+  std::uint64_t allocations_last_frame = 0;
+  // allocations served by the arena
+  std::uint64_t arena_allocations = 0;
+  // allocations refused because of `HostAllocatorOptions::max_bytes` or the system running out of memory
+  std::uint64_t failed_allocations = 0;
+};
+
+/**
+ * @brief Kind of GPU to prefer when there are multiple
+ */
+enum class GpuPreference {
+  // discrete GPUs first
+  high_performance,
+  // integrated GPUs first, e.g. to save battery on hybrid GPU laptops
+  low_power,
+};
+
+/**
+ * @brief Physical device selection policy. Devices that can't render, or present to the window, are never picked
+ */
+struct GpuSelection {
+  GpuPreference preference = GpuPreference::high_performance;
+  // Explicit device: enumeration index, device UUID in hex or a case insensitive part of the device name, empty to
+  // pick by preference and then device local memory. The `IMGUI_VK_GPU` environment variable takes precedence
+  std::string device;
+};
+
+enum class GpuType {
+  other,
+  integrated,
+  discrete,
+  virtual_gpu,
+  cpu,
+};
+
+/**
+ * @brief Physical device a window renders with
+ */
+struct DeviceInfo {
+  std::string name;
+  // index in Vulkan enumeration order
+  std::uint32_t index = 0;
+  std::uint32_t vendor_id = 0;
+  std::uint32_t device_id = 0;
+  std::uint32_t driver_version = 0;
+  // all zero if the device doesn't support Vulkan 1.1
+  std::array<std::uint8_t, 16> uuid{};
+  GpuType type = GpuType::other;
+  // total size of the device local memory heaps
+  std::uint64_t device_local_bytes = 0;
+  // whether uploads use a dedicated transfer queue
+  bool transfer_queue = false;
+};
+
+/**
+ * @brief Recording of large draw data into secondary command buffers on worker threads
+ */
+struct ParallelRecording {
+  // worker threads in addition to the rendering thread, 0 to always record on a single thread
+  std::uint32_t threads = 0;
+  // draw data with fewer vertices, or with user callbacks, is recorded on a single thread
+  std::uint32_t min_vertices = 64 * 1024;
+};
+
+/**
+ * @brief Latency versus power trade-off of a window, can be changed while the window is running
+ */
+struct PresentPolicy {
+  PresentMode mode = PresentMode::fifo;
+  // Target frame rate of the CPU frame limiter, 0 to disable
+  float target_fps = 0;
+  // Wait for the oldest frame in flight to be displayed before polling events, so that input is sampled as late as
+  // possible. Waits until it has been rendered without VK_KHR_present_wait, no effect with threaded rendering
+  bool low_latency = false;
+};
+
+/**
+ * @brief Resolution the main window is rendered at relative to its size, see `Window::set_render_scale_policy`
+ */
+struct RenderScalePolicy {
+  // fixed scale, or the initial one when adapting. 1 renders straight into the swap chain images
+  float scale = 1;
+  // GPU frame rate to hold by adjusting the scale from the measured GPU time, 0 to keep the scale fixed. Needs GPU
+  // timestamp queries, see `build_config.instrumentation`
+  float target_fps = 0;
+  // bounds of the adapted scale, both are clamped to [0.25, 1] like a fixed scale
+  float min_scale = 0.5f;
+  float max_scale = 1;
+};
+
+/**
+ * @brief SDL2 GUI application. All windows are driven by a single event loop and share one Vulkan instance, device,
+ * queue, pipeline cache and descriptor pool, each with its own surface, swapchain and ImGui context. Device wide
+ * settings (pipeline cache directory and host allocation) are taken from the first window shown.
+ *
+ */
+class Application {
+ public:
+  /**
+   * @brief Construct a new Application object with main window. Sets up SDL2 environment
+   *
+   * @param window main window
+   */
+  Application(Window* window);
+
+  /**
+   * @brief Construct a new Application object with multiple windows. Sets up SDL2 environment
+   *
+   * @param windows windows to show, in order
+   */
+  Application(std::span<Window* const> windows);
+
+  /**
+   * @brief Destroy the Application object. Cleans up SDL2 environment.
+   */
+  ~Application() noexcept;
+
+  /**
+   * @brief Add a window to show. Windows added while running, e.g. from `Window::on_gui()`, are shown with the next
+   * loop iteration
+   *
+   * @param window window that outlives the application
+   */
+  void add_window(Window* window);
+
+  /**
+   * @brief Display all windows until every one of them is closed. Caught exceptions are printed to stderr.
+   *
+   * @return int Exit code
+   */
+  auto run() noexcept -> int;
+
+ private:
+  // shown windows
+  std::vector<Window*> windows_;
+  // windows waiting to be shown
+  std::vector<Window*> pending_;
+
+  /**
+   * @brief Wait until any window has to draw again and collect all pending events
+   */
+  void wait_events(std::vector<SDL_Event>& events) const;
+};
+
+/**
+ * @brief Vulkan/SDL2 ImGui window. Pass to `Application` to run.
+ *
+ */
+class Window {
+ public:
+  /**
+   * @brief Construct a new Window object
+   *
+   * @param name Window name
+   * @param width Window width in pixels
+   * @param height Window height in pixels
+   */
+  Window(std::string name, int width, int height) noexcept;
+
+  virtual ~Window() noexcept;
+
+  /**
+   * @brief Close the window
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Set the directory where the Vulkan pipeline cache is persisted between runs. Only takes effect before the
+   * window is shown. If empty (default), SDL preferences path for the window name is used.
+   *
+   * @param directory Pipeline cache directory
+   */
+  void set_pipeline_cache_directory(std::filesystem::path directory) noexcept;
+
+  /**
+   * @brief Enable power saving mode: when no input has arrived for `idle_frames()` frames, the window stops redrawing
+   * and blocks until the next event, `request_redraw()` or idle refresh
+   *
+   * @param enable Whether to enable power saving mode, disabled by default
+   */
+  void set_power_saving(bool enable) noexcept;
+
+  /**
+   * @brief Set the maximum refresh rate while idle in power saving mode
+   *
+   * @param fps Maximum frames per second, 0 to only redraw on events
+   */
+  void set_max_idle_fps(float fps) noexcept;
+
+  /**
+   * @brief Set the number of frames to keep rendering after the last input so that animations can settle
+   *
+   * @param frames Number of frames
+   */
+  void set_idle_frames(int frames) noexcept;
+
+  /**
+   * @brief Wake the window up in power saving mode to render at least one more frame, e.g. after a background data
+   * update. Safe to call from any thread
+   */
+  void request_redraw() noexcept;
+
+  /**
+   * @brief Set the presentation mode and frame limiter. Changing the mode recreates the swapchain before the next
+   * frame. The default mode is `build_config.present_mode`, `PresentMode::mailbox` if the library was built with
+   * `IMGUI_UNLIMITED_FRAME_RATE`, otherwise `PresentMode::fifo`
+   *
+   * @param policy Present policy
+   */
+  void set_present_policy(PresentPolicy policy);
+
+  /**
+   * @brief Render ImGui into an intermediate image at a fraction of the window resolution and upscale it into the swap
+   * chain image with a linear blit, trading sharpness for fill rate on large displays driven by weak GPUs. The
+   * intermediate image is sized for the whole window so that the scale can change every frame without reallocating.
+   * Has no effect if the swap chain images can't be blitted to. Viewport windows are always rendered at full resolution
+   *
+   * @param policy Render scale policy
+   */
+  void set_render_scale_policy(RenderScalePolicy const& policy);
+
+  /**
+   * @brief Scale the most recent frame was rendered at, 1 before the first frame. Safe to call from any thread
+   */
+  [[nodiscard]] auto render_scale() const noexcept -> float;
+
+  /**
+   * @brief Skip submitting and presenting frames whose draw data, texture IDs and clear color are identical to the
+   * last presented frame. Frames with user draw callbacks are never skipped. If the device supports
+   * `VK_KHR_incremental_present`, changed frames tell the compositor which draw lists changed
+   *
+   * @param enable Whether to skip unchanged frames, disabled by default
+   */
+  void set_skip_unchanged_frames(bool enable) noexcept;
+
+  /**
+   * @brief Set the number of frames the CPU may prepare ahead of the GPU, independent of the swapchain image count.
+   * More frames let `on_gui()` of the next frame overlap with GPU rendering of the previous ones at the cost of
+   * latency. Only takes effect before the window is shown
+   *
+   * @param frames Number of frames in flight, at least 1, `build_config.frames_in_flight` (2) by default
+   */
+  void set_frames_in_flight(std::uint32_t frames) noexcept;
+
+  /**
+   * @brief Record, submit and present frames on a dedicated render thread so that blocking in the driver or compositor
+   * does not stall input handling. The UI thread hands over deep copies of the draw data through a triple buffer and
+   * runs at most 2 frames ahead. Only takes effect before the window is shown. The ImGui Vulkan backend finds its
+   * state through the current context, so unless imconfig.h redirects `GImGui` to a thread local, only a window shown
+   * on its own gets a render thread. Showing another window moves its rendering back to the UI thread for good
+   *
+   * @param enable Whether to use a render thread, disabled by default. Ignored without
+   * `build_config.threaded_rendering`
+   */
+  void set_threaded_rendering(bool enable) noexcept;
+
+  /**
+   * @brief Use custom host memory allocation callbacks for all Vulkan objects. Only takes effect before the window is
+   * shown, overrides the built-in allocator
+   *
+   * @param callbacks Allocation callbacks that outlive the window, nullptr (default) to use the driver allocator
+   */
+  void set_allocation_callbacks(VkAllocationCallbacks const* callbacks) noexcept;
+
+  /**
+   * @brief Use the built-in Vulkan host memory allocator: size class pools that are kept for reuse, e.g. when the
+   * swapchain is recreated, and an arena for transient allocations. Only takes effect before the window is shown
+   *
+   * @param options Allocator options, disabled by default
+   */
+  void set_host_allocator(HostAllocatorOptions const& options) noexcept;
+
+  /**
+   * @brief Set how the GPU is picked on multi GPU systems. Only takes effect before the window is shown, and with
+   * multiple windows only for the first one shown
+   *
+   * @param selection GPU selection policy, prefers discrete GPUs by default
+   */
+  void set_gpu_selection(GpuSelection selection) noexcept;
+
+  /**
+   * @brief Physical device the window renders or last rendered with, empty before the window is first shown. Only safe
+   * to call from the UI thread
+   */
+  [[nodiscard]] auto device_info() const noexcept -> DeviceInfo const&;
+
+  /**
+   * @brief Set the size of the persistently mapped staging buffer that texture and font uploads are copied through.
+   * Uploads that don't fit get a dedicated staging buffer instead of waiting. Only takes effect before the window is
+   * shown
+   *
+   * @param bytes Staging buffer size, 8 MiB by default
+   */
+  void set_staging_buffer_size(std::size_t bytes) noexcept;
+
+  /**
+   * @brief Place the persistently mapped vertex and index ring in device local memory that the CPU can write to
+   * directly, e.g. with resizable BAR or on integrated GPUs, so that the GPU doesn't read geometry over the bus. Falls
+   * back to host memory if there's no such memory type. Only takes effect before the window is shown
+   *
+   * @param enable Whether to prefer device local memory, disabled by default
+   */
+  void set_device_local_geometry(bool enable) noexcept;
+
+  /**
+   * @brief Split the draw lists of large frames across worker threads that each record a secondary command buffer.
+   * Draw lists are never split, so this only helps with many windows. Only takes effect before the window is shown
+   *
+   * @param options Worker count and threshold, disabled by default
+   */
+  void set_parallel_recording(ParallelRecording const& options) noexcept;
+
+  /**
+   * @brief Let ImGui windows, e.g. docked ones, be dragged out into their own OS windows. Every viewport gets its own
+   * swap chain on the shared device, all of them are drawn in one submission together with the main window and
+   * presented with a single vkQueuePresentKHR. Needs an ImGui build with viewports (IMGUI_HAS_VIEWPORT, the docking
+   * branch) and is ignored with threaded rendering. Only takes effect before the window is shown
+   *
+   * @param enable Whether to enable multiple viewports, disabled by default
+   */
+  void set_multi_viewports(bool enable) noexcept;
+
+  /**
+   * @brief Render the window multisampled into a transient, lazily allocated image that is resolved at the end of the
+   * render pass, so that on tile based GPUs the samples never leave tile memory. ImGui's own anti-aliasing of lines
+   * and fills is turned off when multisampling, which cuts the vertex count of dense plots. Viewport windows stay
+   * single sampled. Only takes effect before the window is shown
+   *
+   * @param samples Samples per pixel, 1 (the default) to disable, rounded down to a count the device supports
+   */
+  void set_msaa_samples(std::uint32_t samples) noexcept;
+
+  /**
+   * @brief Upload an RGBA8 texture without waiting for the GPU. The copy is recorded at the start of the next frame so
+   * the texture can be drawn with `ImGui::Image()` right away. Must be called from the UI thread while the window is
+   * shown. Only textures uploaded this way can be drawn, descriptor sets from `ImGui_ImplVulkan_AddTexture()` have a
+   * different layout
+   *
+   * @param rgba Tightly packed pixels, copied before returning
+   * @param width Texture width in pixels
+   * @param height Texture height in pixels
+   * @return ImTextureID Texture handle, valid until `destroy_texture()` or the window is closed
+   * @throws GUIError if the window is not shown, the data doesn't match the size or on Vulkan errors
+   */
+  [[nodiscard]] auto upload_texture(std::span<std::uint8_t const> rgba, int width, int height) -> ImTextureID;
+
+  /**
+   * @brief Destroy a texture from `upload_texture()` once the frames in flight are done with it. Must be called from
+   * the UI thread while the window is shown
+   *
+   * @param texture Texture handle, must not be drawn anymore
+   */
+  void destroy_texture(ImTextureID texture);
+
+  /**
+   * @brief Clear the font atlas and fill it again through `on_load_fonts()` before the next frame. The new atlas is
+   * uploaded like any other texture, without stalling the GPU. Invalidates all `ImFont` pointers
+   */
+  void rebuild_fonts() noexcept;
+
+  /**
+   * @brief Copy every rendered frame of the main window into host memory and hand it to `on_frame_captured()` once the
+   * GPU has finished the frame, usually as many frames later as there are frames in flight. The copy is recorded at the
+   * end of the frame itself so nothing waits for it. Frames skipped as unchanged are not captured, neither are windows
+   * whose surface doesn't allow copying from the swap chain images
+   *
+   * @param enable Whether to capture frames
+   */
+  void set_frame_capture(bool enable) noexcept;
+
+  /**
+   * @brief Capture only the next rendered frame, see `set_frame_capture()`. Does nothing if the window is not shown
+   */
+  void capture_next_frame() noexcept;
+
+  /**
+   * @brief Counters of the built-in host memory allocator, all zero if it's not used. Safe to call from any thread
+   */
+  [[nodiscard]] auto host_memory_stats() const noexcept -> HostMemoryStats;
+
+  /**
+   * @brief Number of frames that were not submitted because they were unchanged. Safe to call from any thread
+   */
+  [[nodiscard]] auto skipped_frames() const noexcept -> std::uint64_t;
+
+  /**
+   * @brief Counters of the texture descriptor set allocator, all zero if the window is not shown. Only safe to call
+   * from the UI thread
+   */
+  [[nodiscard]] auto descriptor_stats() const -> DescriptorStats;
+
+  /**
+   * @brief Show built-in ImGui overlay with frame timing statistics
+   *
+   * @param enable Whether to show the overlay
+   */
+  void set_stats_overlay(bool enable) noexcept;
+
+  /**
+   * @brief Compute frame timing statistics over the most recent frames. Safe to call from any thread
+   *
+   * @param frames Number of frames to compute statistics over, limited by `frame_history_size`
+   * @return FrameStats Timing statistics
+   */
+  [[nodiscard]] auto frame_stats(std::size_t frames = 120) const -> FrameStats;
+
+  /**
+   * @brief Copy raw timings of the most recent frames, oldest first. Safe to call from any thread
+   *
+   * @param out Destination
+   * @return std::size_t Number of frames copied
+   */
+  [[nodiscard]] auto frame_timings(std::span<FrameTimings> out) const noexcept -> std::size_t;
+
+  /**
+   * @brief Durations of the startup steps of the last time the window was shown. Only safe to call from the UI thread
+   */
+  [[nodiscard]] auto startup_timings() const noexcept -> StartupTimings;
+
+  /**
+   * @brief Render the window offscreen for a fixed number of frames without an SDL window, blocks until done. Does
+   * not require an `Application`. Intended for benchmarks and automated performance tests
+   *
+   * @param options Headless run options
+   * @return HeadlessReport Throughput and frame timings of the run
+   * @throws GUIError on Vulkan errors
+   */
+  auto run_headless(HeadlessOptions const& options = {}) -> HeadlessReport;
+
+  [[nodiscard]] auto name() const noexcept -> std::string_view;
+  [[nodiscard]] auto is_running() const noexcept -> bool;
+  [[nodiscard]] auto width() const noexcept -> int;
+  [[nodiscard]] auto height() const noexcept -> int;
+  [[nodiscard]] auto pipeline_cache_directory() const noexcept -> std::filesystem::path const&;
+  [[nodiscard]] auto power_saving() const noexcept -> bool;
+  [[nodiscard]] auto max_idle_fps() const noexcept -> float;
+  [[nodiscard]] auto idle_frames() const noexcept -> int;
+  [[nodiscard]] auto present_policy() const noexcept -> PresentPolicy const&;
+  [[nodiscard]] auto render_scale_policy() const noexcept -> RenderScalePolicy const&;
+  [[nodiscard]] auto skip_unchanged_frames() const noexcept -> bool;
+  [[nodiscard]] auto frames_in_flight() const noexcept -> std::uint32_t;
+  [[nodiscard]] auto threaded_rendering() const noexcept -> bool;
+  [[nodiscard]] auto allocation_callbacks() const noexcept -> VkAllocationCallbacks const*;
+  [[nodiscard]] auto host_allocator() const noexcept -> HostAllocatorOptions const&;
+  [[nodiscard]] auto staging_buffer_size() const noexcept -> std::size_t;
+  [[nodiscard]] auto device_local_geometry() const noexcept -> bool;
+  [[nodiscard]] auto parallel_recording() const noexcept -> ParallelRecording const&;
+  [[nodiscard]] auto multi_viewports() const noexcept -> bool;
+  // the sample count the device supports once the window is shown
+  [[nodiscard]] auto msaa_samples() const noexcept -> std::uint32_t;
+  [[nodiscard]] auto gpu_selection() const noexcept -> GpuSelection const&;
+  [[nodiscard]] auto stats_overlay() const noexcept -> bool;
+
+  constexpr static std::size_t frame_history_size = 512;
+
+ protected:
+  /**
+   * @brief Main entry point for ImGui implementation, everything is setup by this point. Called once per draw loop
+   */
+  virtual void on_gui() = 0;
+
+  /**
+   * @brief Change window parameters before rendering, called every loop just before rendering the frame in Vulkan and
+   * after the draw data has been prepared. Requires `#include <imgui_impl_vulkan.h>`. With threaded rendering this is
+   * called on the render thread with a copy of the draw data, any state shared with `on_gui()` has to be synchronized
+   *
+   * @param wd Vulkan window parameters
+   * @param draw_data ImGui draw data
+   */
+  virtual void before_render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data);
+
+  /**
+   * @brief Generate input for a headless frame, called before `on_gui()`. Default implementation sweeps the mouse
+   * over the display
+   *
+   * @param io ImGui IO to add input events to
+   * @param frame Frame index since the start of the headless run
+   */
+  virtual void on_synthetic_input(ImGuiIO& io, std::uint64_t frame);
+
+  /**
+   * @brief Add fonts to the cleared atlas, called when the window is shown and after `rebuild_fonts()`. Default
+   * implementation adds nothing so that ImGui uses its default font. When the window is shown this is called before
+   * its ImGui context exists, while the pipeline is built on a worker thread. Only use `fonts` here
+   *
+   * @param fonts Font atlas of the window
+   */
+  virtual void on_load_fonts(ImFontAtlas& fonts);
+
+  /**
+   * @brief Receive a frame captured through `set_frame_capture()` or `capture_next_frame()`, called in frame order.
+   * With threaded rendering this is called on the render thread. Captures of frames still in flight when the window is
+   * closed are dropped, headless runs deliver all of them before returning
+   *
+   * @param capture Pixels of the frame, copy them to keep them
+   */
+  virtual void on_frame_captured(FrameCapture const& capture);
+
+ private:
+  std::string name_;
+  std::array<int, 2> size_;
+  bool running_ = false;
+  std::filesystem::path pipeline_cache_directory_;
+  bool power_saving_ = false;
+  float max_idle_fps_ = 0;
+  int idle_frames_ = 3;
+  // frames left to render before going idle
+  int frames_to_render_ = 0;
+  std::atomic<bool> redraw_requested_ = false;
+  PresentPolicy present_policy_;
+  RenderScalePolicy render_scale_policy_;
+  bool skip_unchanged_frames_ = false;
+  std::atomic<std::uint64_t> skipped_frames_ = 0;
+  // set by whichever thread skipped the last frame, paces the next one since skipping doesn't block on present
+  std::atomic<bool> frame_skipped_ = false;
+  // deadline of the next frame for the frame limiter
+  std::chrono::steady_clock::time_point next_frame_time_;
+  // milliseconds spent in wait_for_frame before the events of the next frame were polled
+  float frame_wait_ = 0;
+  // oldest input event that has not been drawn yet, kept across frames skipped by the limiter or power saving
+  std::optional<std::chrono::steady_clock::time_point> input_time_;
+  // deadline of the next idle refresh in power saving mode
+  std::chrono::steady_clock::time_point idle_deadline_;
+  std::uint32_t frames_in_flight_ = build_config.frames_in_flight;
+  bool threaded_rendering_ = false;
+  VkAllocationCallbacks const* allocation_callbacks_ = nullptr;
+  HostAllocatorOptions host_allocator_options_;
+  std::size_t staging_buffer_size_ = 8 * 1024 * 1024;
+  bool device_local_geometry_ = false;
+  ParallelRecording parallel_recording_;
+  bool multi_viewports_ = false;
+  std::uint32_t msaa_samples_ = 1;
+  GpuSelection gpu_selection_;
+  DeviceInfo device_info_;
+  bool fonts_dirty_ = false;
+  // atlas of the ImGui context, outlives the context
+  std::unique_ptr<ImFontAtlas> fonts_;
+  StartupTimings startup_;
+  std::chrono::steady_clock::time_point startup_begin_;
+  // written by the worker building the pipeline and by the thread ending the first frame
+  std::atomic<float> startup_pipeline_ = 0;
+  std::atomic<float> startup_first_frame_ = 0;
+  bool stats_overlay_ = false;
+  bool frame_capture_ = false;
+  std::uint64_t frame_count_ = 0;
+  RingBuffer<FrameTimings, frame_history_size> frame_timings_;
+  // noop deleter, cleaned up after the window is closed
+  SDL_Window* window_ = nullptr;
+  // created on first show if enabled, shared with the device which may outlive the window
+  std::shared_ptr<HostAllocator> host_allocator_;
+  // PIMPL for all Vulkan related stuff, cleaned up with the window
+  std::unique_ptr<Vulkan> vulkan_;
+  // only set while shown with threaded rendering, stopped before Vulkan is cleaned up
+  std::unique_ptr<RenderThread> render_thread_;
+  // ImGui context of this window, current while the window is drawn
+  ImGuiContext* imgui_context_ = nullptr;
+
+  friend class Application;
+
+  /**
+   * @brief Wait for the GPU and presentation engine in low latency mode, called before the application polls events
+   */
+  void wait_for_frame();
+
+  /**
+   * @brief Handle the events addressed to this window and draw the GUI once if needed, called by the application loop
+   */
+  void draw(std::span<SDL_Event const> events);
+
+  /**
+   * @brief Whether the window is waiting for events in power saving mode
+   */
+  [[nodiscard]] auto is_idle() const noexcept -> bool;
+
+  /**
+   * @brief Earliest time the window wants to draw again, `time_point::max()` if only on events
+   */
+  [[nodiscard]] auto next_draw_time() const noexcept -> std::chrono::steady_clock::time_point;
+
+  /**
+   * @brief Build the GUI and render it, shared by the windowed and headless loops
+   */
+  void draw_frame(PhaseTimer& timer);
+
+  /**
+   * @brief Draw a single headless frame
+   */
+  void draw_headless(HeadlessOptions const& options, std::uint64_t frame);
+
+  /**
+   * @brief Draw frame timing statistics overlay
+   */
+  void draw_stats_overlay();
+
+  /**
+   * @brief Start the render thread if threaded rendering is enabled and no other window needs the current context
+   */
+  void start_render_thread();
+
+  /**
+   * @brief Join the render thread if there is one
+   */
+  void stop_render_thread() noexcept;
+
+  /**
+   * @brief Allocation callbacks to create the Vulkan device with, creates the built-in allocator if needed
+   */
+  [[nodiscard]] auto make_allocation_callbacks() -> VkAllocationCallbacks const*;
+
+  /**
+   * @brief Rebuild the font atlas and upload it
+   */
+  void load_fonts();
+
+  /**
+   * @brief Start timing the steps of showing the window
+   */
+  void reset_startup_timings() noexcept;
+
+  /**
+   * @brief Build the atlas the ImGui context is created with through `on_load_fonts()`
+   */
+  void build_fonts();
+
+  /**
+   * @brief Record timings of a finished frame and reset per frame counters
+   */
+  void end_frame(FrameTimings const& timings);
+
+  /**
+   * @brief Create the SDL window and its Vulkan resources
+   *
+   * @param device Device shared with the other windows, created from this window's settings if null
+   */
+  void create(std::shared_ptr<Device>& device);
+
+  /**
+   * @brief Destroy everything created by `create()`, the device is released with the last window using it
+   */
+  void destroy();
+};
+
+inline void Window::close() noexcept { running_ = false; }
+
+inline void Window::set_pipeline_cache_directory(std::filesystem::path directory) noexcept {
+  pipeline_cache_directory_ = std::move(directory);
+}
+
+inline void Window::set_stats_overlay(bool enable) noexcept { stats_overlay_ = enable; }
+
+[[nodiscard]] inline auto Window::frame_timings(std::span<FrameTimings> out) const noexcept -> std::size_t {
+  return frame_timings_.copy_latest(out);
+}
+
+inline void Window::set_power_saving(bool enable) noexcept { power_saving_ = enable; }
+
+inline void Window::set_skip_unchanged_frames(bool enable) noexcept { skip_unchanged_frames_ = enable; }
+
+inline void Window::set_max_idle_fps(float fps) noexcept { max_idle_fps_ = fps; }
+
+inline void Window::set_idle_frames(int frames) noexcept { idle_frames_ = frames; }
+
+inline void Window::set_frames_in_flight(std::uint32_t frames) noexcept { frames_in_flight_ = std::max(frames, 1u); }
+
+inline void Window::set_threaded_rendering(bool enable) noexcept {
+  threaded_rendering_ = build_config.threaded_rendering && enable;
+}
+
+inline void Window::set_allocation_callbacks(VkAllocationCallbacks const* callbacks) noexcept {
+  allocation_callbacks_ = callbacks;
+}
+
+inline void Window::set_host_allocator(HostAllocatorOptions const& options) noexcept {
+  host_allocator_options_ = options;
+}
+
+inline void Window::set_staging_buffer_size(std::size_t bytes) noexcept { staging_buffer_size_ = bytes; }
+
+inline void Window::set_device_local_geometry(bool enable) noexcept { device_local_geometry_ = enable; }
+
+inline void Window::set_parallel_recording(ParallelRecording const& options) noexcept {
+  parallel_recording_ = options;
+}
+
+inline void Window::set_multi_viewports(bool enable) noexcept { multi_viewports_ = enable; }
+
+inline void Window::set_msaa_samples(std::uint32_t samples) noexcept { msaa_samples_ = std::max(samples, 1u); }
+
+inline void Window::rebuild_fonts() noexcept { fonts_dirty_ = true; }
+
+inline void Window::set_gpu_selection(GpuSelection selection) noexcept { gpu_selection_ = std::move(selection); }
+
+[[nodiscard]] inline auto Window::device_info() const noexcept -> DeviceInfo const& { return device_info_; }
+
+[[nodiscard]] inline auto Window::name() const noexcept -> std::string_view { return name_; }
+
+[[nodiscard]] inline auto Window::is_running() const noexcept -> bool { return running_; }
+
+[[nodiscard]] inline auto Window::width() const noexcept -> int { return size_[0]; }
+
+[[nodiscard]] inline auto Window::height() const noexcept -> int { return size_[1]; }
+
+[[nodiscard]] inline auto Window::pipeline_cache_directory() const noexcept -> std::filesystem::path const& {
+  return pipeline_cache_directory_;
+}
+
+[[nodiscard]] inline auto Window::power_saving() const noexcept -> bool { return power_saving_; }
+
+[[nodiscard]] inline auto Window::skip_unchanged_frames() const noexcept -> bool { return skip_unchanged_frames_; }
+
+[[nodiscard]] inline auto Window::skipped_frames() const noexcept -> std::uint64_t { return skipped_frames_; }
+
+[[nodiscard]] inline auto Window::max_idle_fps() const noexcept -> float { return max_idle_fps_; }
+
+[[nodiscard]] inline auto Window::idle_frames() const noexcept -> int { return idle_frames_; }
+
+[[nodiscard]] inline auto Window::present_policy() const noexcept -> PresentPolicy const& { return present_policy_; }
+
+[[nodiscard]] inline auto Window::render_scale_policy() const noexcept -> RenderScalePolicy const& {
+  return render_scale_policy_;
+}
+
+[[nodiscard]] inline auto Window::frames_in_flight() const noexcept -> std::uint32_t { return frames_in_flight_; }
+
+[[nodiscard]] inline auto Window::threaded_rendering() const noexcept -> bool { return threaded_rendering_; }
+
+[[nodiscard]] inline auto Window::allocation_callbacks() const noexcept -> VkAllocationCallbacks const* {
+  return allocation_callbacks_;
+}
+
+[[nodiscard]] inline auto Window::host_allocator() const noexcept -> HostAllocatorOptions const& {
+  return host_allocator_options_;
+}
+
+[[nodiscard]] inline auto Window::staging_buffer_size() const noexcept -> std::size_t {
+  return staging_buffer_size_;
+}
+
+[[nodiscard]] inline auto Window::device_local_geometry() const noexcept -> bool { return device_local_geometry_; }
+
+[[nodiscard]] inline auto Window::parallel_recording() const noexcept -> ParallelRecording const& {
+  return parallel_recording_;
+}
+
+[[nodiscard]] inline auto Window::multi_viewports() const noexcept -> bool { return multi_viewports_; }
+
+[[nodiscard]] inline auto Window::msaa_samples() const noexcept -> std::uint32_t { return msaa_samples_; }
+
+[[nodiscard]] inline auto Window::gpu_selection() const noexcept -> GpuSelection const& { return gpu_selection_; }
+
+[[nodiscard]] inline auto Window::stats_overlay() const noexcept -> bool { return stats_overlay_; }
+
+template <class T, std::size_t N>
+void RingBuffer<T, N>::push(T const& value) noexcept {
+  auto const head = head_.load(std::memory_order_relaxed);
+  auto& slot = slots_[head % N];
+
+  slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  std::array<std::uint32_t, words> data{};
+  std::memcpy(data.data(), &value, sizeof(T));
+  for (std::size_t i = 0; i < words; ++i) slot.data[i].store(data[i], std::memory_order_relaxed);
+
+  slot.sequence.store(2 * head + 2, std::memory_order_release);
+  head_.store(head + 1, std::memory_order_release);
+}
+
+template <class T, std::size_t N>
+[[nodiscard]] auto RingBuffer<T, N>::copy_latest(std::span<T> out) const noexcept -> std::size_t {
+  auto const head = head_.load(std::memory_order_acquire);
+  auto const count = std::min<std::uint64_t>({head, N, out.size()});
+
+  std::size_t copied = 0;
+  for (auto index = head - count; index < head; ++index) {
+    auto const& slot = slots_[index % N];
+    auto const sequence = 2 * index + 2;
+    // being written or already overwritten by a newer value
+    if (slot.sequence.load(std::memory_order_acquire) != sequence) continue;
+
+    std::array<std::uint32_t, words> data;
+    for (std::size_t i = 0; i < words; ++i) data[i] = slot.data[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // overwritten while copying
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+    std::memcpy(static_cast<void*>(&out[copied++]), data.data(), sizeof(T));
+  }
+  return copied;
+}
+
+template <class T, std::size_t N>
+[[nodiscard]] auto RingBuffer<T, N>::pushed() const noexcept -> std::uint64_t {
+  return head_.load(std::memory_order_acquire);
+}
+
+[[nodiscard]] inline auto GUIError::error() const noexcept -> int { return error_; }
+
+[[nodiscard]] inline auto GUIError::source() const noexcept -> std::source_location { return src_; }
+
+IMGUI_VK_NAMESPACE_END
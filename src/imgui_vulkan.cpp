@@ -1,719 +1,5466 @@
-/**
- * MIT License
- *
- * Copyright (c) 2022, Daumantas Kavolis
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to deal
- * in the Software without restriction, including without limitation the rights
- * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
- * copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
- * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
- * SOFTWARE.
- */
-
-#include "imgui_vulkan/imgui_vulkan.hpp"
-
-#include <cstdlib>
-#include <vector>
-
-#include <SDL.h>
-#include <SDL_vulkan.h>
-#include <fmt/core.h>
-#include <imgui_impl_sdl.h>
-#include <imgui_impl_vulkan.h>
-#include <vulkan/vulkan.h>
-
-IMGUI_VK_NAMESPACE_BEGIN
-
-#if defined(_MSC_VER)
-#  define IMGUI_VK_NOINLINE __declspec(noinline)
-#elif defined(__GNUC__) || defined(__clang__)
-#  define IMGUI_VK_NOINLINE __attribute__((noinline))
-#else
-#  define IMGUI_VK_NOINLINE
-#endif
-
-#ifdef _DEBUG
-#  define IMGUI_VK_DEBUG_REPORT
-#endif
-
-#ifdef IMGUI_VK_DEBUG_REPORT
-auto VKAPI_CALL debug_report(VkDebugReportFlagsEXT flags [[maybe_unused]], VkDebugReportObjectTypeEXT objectType,
-                             uint64_t object [[maybe_unused]], size_t location [[maybe_unused]],
-                             int32_t messageCode [[maybe_unused]], const char* pLayerPrefix [[maybe_unused]],
-                             const char* pMessage, void* pUserData) -> VkBool32 {
-  fmt::print(stderr, "[vulkan] Debug report from ObjectType: {}\nMessage: {}\n\n", objectType, pMessage);
-  return VK_FALSE;
-}
-#endif
-
-template <class F>
-class scope_guard {
- public:
-  explicit scope_guard(F f) noexcept : f_(std::move(f)) {}
-  ~scope_guard() noexcept { f_(); }
-
- private:
-  F f_;
-};
-
-[[noreturn]] IMGUI_VK_NOINLINE static void vthrow_gui_error(
-    std::string const& msg, int code = -1, std::source_location src = std::source_location::current()) {
-  throw GUIError(msg, code, src);
-}
-
-[[noreturn]] IMGUI_VK_NOINLINE static void vthrow_gui_error(
-    char const* msg, int code = -1, std::source_location src = std::source_location::current()) {
-  throw GUIError(msg, code, src);
-}
-
-template <class... Args>
-struct FormatString {
-  using self = FormatString;
-
-  fmt::format_string<Args...> str;
-  std::source_location src;
-
-  consteval FormatString(fmt::format_string<Args...> fmt,
-                         std::source_location s = std::source_location::current()) noexcept
-      : str(fmt), src(s) {}
-
-  template <class S>
-    requires(std::constructible_from<fmt::format_string<Args...>, S> && !std::same_as<S, self>)
-  consteval FormatString(S const& fmt, std::source_location s = std::source_location::current()) noexcept
-      : str(fmt), src(s) {}
-};
-
-template <class... Args>
-[[noreturn]] void throw_gui_error(typename FormatString<Args...>::self fmt, Args&&... args) {
-  vthrow_gui_error(fmt::vformat(fmt.str, fmt::make_format_args(args...)), -1, fmt.src);
-}
-
-template <class... Args>
-[[noreturn]] void throw_gui_error(int code, typename FormatString<Args...>::self fmt, Args&&... args) {
-  vthrow_gui_error(fmt::vformat(fmt.str, fmt::make_format_args(args...)), code, fmt.src);
-}
-
-class Vulkan {
- public:
-  explicit Vulkan(std::span<char const* const> extensions);
-
-  static void check_vk_result(VkResult err);
-  void setup_window(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface, int width, int height);
-  void init(SDL_Window* window);
-  void cleanup();
-  void cleanup_window();
-  void render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data);
-  void present_frame(ImGui_ImplVulkanH_Window* wd);
-  void create_surface(SDL_Window* wd, VkSurfaceKHR* surface);
-  void create_framebuffers(SDL_Window* wd, VkSurfaceKHR surface);
-  void shutdown();
-  void upload_fonts();
-  void maybe_resize_swap_chain(SDL_Window* window);
-
-  [[nodiscard]] auto main_window_data() const noexcept -> ImGui_ImplVulkanH_Window const&;
-  [[nodiscard]] auto main_window_data() noexcept -> ImGui_ImplVulkanH_Window&;
-
- private:
-  VkAllocationCallbacks* allocator_ = nullptr;
-  VkInstance instance_ = nullptr;
-  VkPhysicalDevice physical_device_ = nullptr;
-  VkDevice device_ = nullptr;
-  std::uint32_t queue_family_ = std::numeric_limits<std::uint32_t>::max();
-  VkQueue queue_ = nullptr;
-  VkDebugReportCallbackEXT debug_report_ = nullptr;
-  VkPipelineCache pipeline_cache_ = nullptr;
-  VkDescriptorPool descriptor_pool_ = nullptr;
-
-  ImGui_ImplVulkanH_Window main_window_data_;
-  std::uint32_t min_image_count_ = 2;
-  bool swap_chain_rebuild_ = false;
-};
-
-[[nodiscard]] inline auto Vulkan::main_window_data() const noexcept -> ImGui_ImplVulkanH_Window const& {
-  return main_window_data_;
-}
-[[nodiscard]] inline auto Vulkan::main_window_data() noexcept -> ImGui_ImplVulkanH_Window& { return main_window_data_; }
-
-static auto vk_result_string(VkResult err) noexcept -> char const* {
-  switch (err) {
-#define VK_ERR_STR(e) \
-  case VK_##e: return "VK_" #e
-    VK_ERR_STR(SUCCESS);
-    VK_ERR_STR(ERROR_OUT_OF_HOST_MEMORY);
-    VK_ERR_STR(ERROR_DEVICE_LOST);
-    VK_ERR_STR(ERROR_EXTENSION_NOT_PRESENT);
-    VK_ERR_STR(ERROR_TOO_MANY_OBJECTS);
-    VK_ERR_STR(ERROR_UNKNOWN);
-    VK_ERR_STR(ERROR_FRAGMENTATION);
-    VK_ERR_STR(ERROR_SURFACE_LOST_KHR);
-    VK_ERR_STR(SUBOPTIMAL_KHR);
-    VK_ERR_STR(ERROR_INCOMPATIBLE_DISPLAY_KHR);
-    VK_ERR_STR(ERROR_INVALID_SHADER_NV);
-    VK_ERR_STR(ERROR_NOT_PERMITTED_EXT);
-    VK_ERR_STR(THREAD_IDLE_KHR);
-    VK_ERR_STR(OPERATION_NOT_DEFERRED_KHR);
-    VK_ERR_STR(ERROR_OUT_OF_POOL_MEMORY_KHR);
-    VK_ERR_STR(ERROR_INVALID_EXTERNAL_HANDLE_KHR);
-    VK_ERR_STR(ERROR_INVALID_DEVICE_ADDRESS_EXT);
-    VK_ERR_STR(ERROR_PIPELINE_COMPILE_REQUIRED_EXT);
-    VK_ERR_STR(RESULT_MAX_ENUM);
-#undef VK_ERR_STR
-    default: return "VK_UNKNOWN_ERROR";
-  }
-}
-
-void Vulkan::check_vk_result(VkResult err) {
-  if (err == 0) return;
-  auto str = vk_result_string(err);
-  if (err < 0) {
-    vthrow_gui_error(str, err);
-  } else {
-    std::fprintf(stderr, "[vulkan] Error: VkResult = %s\n", str);
-  }
-}
-
-Vulkan::Vulkan(std::span<char const* const> extensions) {
-  VkResult err;
-
-  // Create Vulkan Instance
-  {
-    VkInstanceCreateInfo create_info{
-        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-        .enabledExtensionCount = static_cast<std::uint32_t>(extensions.size()),
-        .ppEnabledExtensionNames = extensions.data(),
-    };
-#ifdef IMGUI_VK_DEBUG_REPORT
-    // Enabling validation layers
-    constexpr static std::array<const char*, 1> layers{"VK_LAYER_KHRONOS_validation"};
-    create_info.enabledLayerCount = static_cast<std::uint32_t>(layers.size());
-    create_info.ppEnabledLayerNames = layers.data();
-
-    // Enable debug report extension (we need additional storage, so we duplicate the user array to add our new
-    // extension to it)
-    std::vector<char const*> extensions_ext(extensions.size() + 1);
-    std::ranges::copy(extensions, extensions_ext.begin());
-    extensions_ext.back() = "VK_EXT_debug_report";
-    create_info.enabledExtensionCount = static_cast<std::uint32_t>(extensions_ext.size());
-    create_info.ppEnabledExtensionNames = extensions_ext.data();
-
-    // Create Vulkan Instance
-    err = vkCreateInstance(&create_info, allocator_, &instance_);
-    check_vk_result(err);
-
-    // Get the function pointer (required for any extensions)
-    auto vkCreateDebugReportCallbackEXT = static_cast<PFN_vkCreateDebugReportCallbackEXT>(
-        vkGetInstanceProcAddr(instance_, "vkCreateDebugReportCallbackEXT"));
-    if (vkCreateDebugReportCallbackEXT == nullptr) [[unlikely]]
-      vthrow_gui_error("Could not get vkCreateDebugReportCallbackEXT");
-
-    // Setup the debug report callback
-    VkDebugReportCallbackCreateInfoEXT debug_report_ci{
-        .sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT,
-        .flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT |
-                 VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
-        .pfnCallback = debug_report,
-        .pUserData = nullptr,
-    };
-    err = vkCreateDebugReportCallbackEXT(instance_, &debug_report_ci, allocator_, &debug_report_);
-    check_vk_result(err);
-#else
-    // Create Vulkan Instance without any debug feature
-    err = vkCreateInstance(&create_info, allocator_, &instance_);
-    check_vk_result(err);
-#endif
-  }
-
-  // Select GPU
-  {
-    uint32_t gpu_count;
-    err = vkEnumeratePhysicalDevices(instance_, &gpu_count, nullptr);
-    check_vk_result(err);
-    if (gpu_count == 0) [[unlikely]] { vthrow_gui_error("Could not find any GPUs!"); }
-
-    std::vector<VkPhysicalDevice> gpus(gpu_count);
-    err = vkEnumeratePhysicalDevices(instance_, &gpu_count, gpus.data());
-    check_vk_result(err);
-
-    // If a number >1 of GPUs got reported, find discrete GPU if present, or use first one available. This covers
-    // most common cases (multi-gpu/integrated+dedicated graphics). Handling more complicated setups (multiple
-    // dedicated GPUs) is out of scope of this sample.
-    for (auto const& gpu : gpus) {
-      VkPhysicalDeviceProperties properties;
-      vkGetPhysicalDeviceProperties(gpu, &properties);
-      if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-        physical_device_ = gpu;
-        break;
-      }
-    }
-  }
-
-  // Select graphics queue family
-  {
-    uint32_t count;
-    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &count, nullptr);
-    std::vector<VkQueueFamilyProperties> queues(count);
-    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &count, queues.data());
-    auto queue_it =
-        std::ranges::find_if(queues, [](auto const& queue) { return queue.queueFlags & VK_QUEUE_GRAPHICS_BIT; });
-
-    if (queue_it == queues.end()) [[unlikely]] { vthrow_gui_error("Could not find graphics queue"); }
-    queue_family_ = static_cast<std::uint32_t>(queue_it - queues.begin());
-  }
-
-  // Create Logical Device (with 1 queue)
-  {
-    constexpr static std::array<const char*, 1> device_extensions{"VK_KHR_swapchain"};
-    std::array<float, 1> queue_priority{1.0f};
-    VkDeviceQueueCreateInfo queue_info{
-        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-        .queueFamilyIndex = queue_family_,
-        .queueCount = static_cast<std::uint32_t>(queue_priority.size()),
-        .pQueuePriorities = queue_priority.data(),
-    };
-    VkDeviceCreateInfo create_info{
-        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &queue_info,
-        .enabledExtensionCount = static_cast<std::uint32_t>(device_extensions.size()),
-        .ppEnabledExtensionNames = device_extensions.data(),
-    };
-    err = vkCreateDevice(physical_device_, &create_info, allocator_, &device_);
-    check_vk_result(err);
-    vkGetDeviceQueue(device_, queue_family_, 0, &queue_);
-  }
-
-  // Create Descriptor Pool
-  {
-    constexpr static auto pool_sizes = std::to_array<VkDescriptorPoolSize>({
-        {VK_DESCRIPTOR_TYPE_SAMPLER, 1000},
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000},
-        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1000},
-        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1000},
-        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1000},
-        {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1000},
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000},
-        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000},
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1000},
-        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1000},
-        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1000},
-    });
-    VkDescriptorPoolCreateInfo pool_info{
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-        .maxSets = 1000 * static_cast<std::uint32_t>(pool_sizes.size()),
-        .poolSizeCount = static_cast<std::uint32_t>(pool_sizes.size()),
-        .pPoolSizes = pool_sizes.data(),
-    };
-    err = vkCreateDescriptorPool(device_, &pool_info, allocator_, &descriptor_pool_);
-    check_vk_result(err);
-  }
-}
-
-void Vulkan::setup_window(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface, int width, int height) {
-  wd->Surface = surface;
-
-  // Check for WSI support
-  VkBool32 res;
-  vkGetPhysicalDeviceSurfaceSupportKHR(physical_device_, queue_family_, wd->Surface, &res);
-  if (res != VK_TRUE) [[unlikely]] { vthrow_gui_error("Error no WSI support on physical device 0"); }
-
-  // Select Surface Format
-  constexpr static auto requestSurfaceImageFormat = std::to_array<VkFormat>({
-      VK_FORMAT_B8G8R8A8_UNORM,
-      VK_FORMAT_R8G8B8A8_UNORM,
-      VK_FORMAT_B8G8R8_UNORM,
-      VK_FORMAT_R8G8B8_UNORM,
-  });
-  constexpr static VkColorSpaceKHR requestSurfaceColorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
-  wd->SurfaceFormat = ImGui_ImplVulkanH_SelectSurfaceFormat(
-      physical_device_, wd->Surface, requestSurfaceImageFormat.data(),
-      static_cast<int>(requestSurfaceImageFormat.size()), requestSurfaceColorSpace);
-
-  // Select Present Mode
-  constexpr static auto present_modes = std::to_array<VkPresentModeKHR>({
-#ifdef IMGUI_UNLIMITED_FRAME_RATE
-      VK_PRESENT_MODE_MAILBOX_KHR,
-      VK_PRESENT_MODE_IMMEDIATE_KHR,
-      VK_PRESENT_MODE_FIFO_KHR,
-#else
-      VK_PRESENT_MODE_FIFO_KHR
-#endif
-  });
-  wd->PresentMode = ImGui_ImplVulkanH_SelectPresentMode(physical_device_, wd->Surface, present_modes.data(),
-                                                        static_cast<int>(present_modes.size()));
-  // printf("[vulkan] Selected PresentMode = %d\n", wd->PresentMode);
-
-  // Create SwapChain, RenderPass, Framebuffer, etc.
-  if (min_image_count_ < 2) [[unlikely]] {
-    throw_gui_error("Need at least 2 frame buffers for swapping, current: {}", min_image_count_);
-  }
-  ImGui_ImplVulkanH_CreateOrResizeWindow(instance_, physical_device_, device_, wd, queue_family_, allocator_, width,
-                                         height, min_image_count_);
-}
-
-void Vulkan::init(SDL_Window* window) {
-  ImGui_ImplSDL2_InitForVulkan(window);
-  ImGui_ImplVulkan_InitInfo init_info{
-      .Instance = instance_,
-      .PhysicalDevice = physical_device_,
-      .Device = device_,
-      .QueueFamily = queue_family_,
-      .Queue = queue_,
-      .PipelineCache = pipeline_cache_,
-      .DescriptorPool = descriptor_pool_,
-      .Subpass = 0,
-      .MinImageCount = min_image_count_,
-      .ImageCount = main_window_data_.ImageCount,
-      .MSAASamples = VK_SAMPLE_COUNT_1_BIT,
-      .Allocator = allocator_,
-      .CheckVkResultFn = check_vk_result,
-  };
-  ImGui_ImplVulkan_Init(&init_info, main_window_data_.RenderPass);
-}
-
-void Vulkan::present_frame(ImGui_ImplVulkanH_Window* wd) {
-  if (swap_chain_rebuild_) return;
-  VkSemaphore render_complete_semaphore = wd->FrameSemaphores[wd->SemaphoreIndex].RenderCompleteSemaphore;
-  VkPresentInfoKHR info{
-      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-      .waitSemaphoreCount = 1,
-      .pWaitSemaphores = &render_complete_semaphore,
-      .swapchainCount = 1,
-      .pSwapchains = &wd->Swapchain,
-      .pImageIndices = &wd->FrameIndex,
-  };
-  VkResult err = vkQueuePresentKHR(queue_, &info);
-  if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
-    swap_chain_rebuild_ = true;
-    return;
-  }
-  check_vk_result(err);
-  wd->SemaphoreIndex = (wd->SemaphoreIndex + 1) % wd->ImageCount;  // Now we can use the next set of semaphores
-}
-
-void Vulkan::render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data) {
-  VkResult err;
-
-  VkSemaphore image_acquired_semaphore = wd->FrameSemaphores[wd->SemaphoreIndex].ImageAcquiredSemaphore;
-  VkSemaphore render_complete_semaphore = wd->FrameSemaphores[wd->SemaphoreIndex].RenderCompleteSemaphore;
-  err = vkAcquireNextImageKHR(device_, wd->Swapchain, std::numeric_limits<std::uint64_t>::max(),
-                              image_acquired_semaphore, nullptr, &wd->FrameIndex);
-  if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
-    swap_chain_rebuild_ = true;
-    return;
-  }
-  check_vk_result(err);
-
-  ImGui_ImplVulkanH_Frame* fd = &wd->Frames[wd->FrameIndex];
-  {
-    // wait indefinitely instead of periodically checking
-    err = vkWaitForFences(device_, 1, &fd->Fence, VK_TRUE, std::numeric_limits<std::uint64_t>::max());
-    check_vk_result(err);
-
-    err = vkResetFences(device_, 1, &fd->Fence);
-    check_vk_result(err);
-  }
-  {
-    err = vkResetCommandPool(device_, fd->CommandPool, 0);
-    check_vk_result(err);
-    VkCommandBufferBeginInfo info{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VkCommandBufferUsageFlags{} | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-    };
-    err = vkBeginCommandBuffer(fd->CommandBuffer, &info);
-    check_vk_result(err);
-  }
-  {
-    VkRenderPassBeginInfo info{
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass = wd->RenderPass,
-        .framebuffer = fd->Framebuffer,
-        .renderArea =
-            {
-                .extent =
-                    {
-                        .width = static_cast<std::uint32_t>(wd->Width),
-                        .height = static_cast<std::uint32_t>(wd->Height),
-                    },
-            },
-        .clearValueCount = 1,
-        .pClearValues = &wd->ClearValue,
-    };
-    vkCmdBeginRenderPass(fd->CommandBuffer, &info, VK_SUBPASS_CONTENTS_INLINE);
-  }
-
-  // Record dear imgui primitives into command buffer
-  ImGui_ImplVulkan_RenderDrawData(draw_data, fd->CommandBuffer);
-
-  // Submit command buffer
-  vkCmdEndRenderPass(fd->CommandBuffer);
-  {
-    VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    VkSubmitInfo info{
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &image_acquired_semaphore,
-        .pWaitDstStageMask = &wait_stage,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &fd->CommandBuffer,
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = &render_complete_semaphore,
-    };
-
-    err = vkEndCommandBuffer(fd->CommandBuffer);
-    check_vk_result(err);
-    err = vkQueueSubmit(queue_, 1, &info, fd->Fence);
-    check_vk_result(err);
-  }
-}
-
-void Vulkan::cleanup() {
-  vkDestroyDescriptorPool(device_, descriptor_pool_, allocator_);
-
-#ifdef IMGUI_VK_DEBUG_REPORT
-  // Remove the debug report callback
-  auto vkDestroyDebugReportCallbackEXT = static_cast<PFN_vkDestroyDebugReportCallbackEXT>(
-      vkGetInstanceProcAddr(instance_, "vkDestroyDebugReportCallbackEXT"));
-  vkDestroyDebugReportCallbackEXT(instance_, debug_report_, allocator_);
-#endif  // IMGUI_VK_DEBUG_REPORT
-
-  vkDestroyDevice(device_, allocator_);
-  vkDestroyInstance(instance_, allocator_);
-}
-
-void Vulkan::shutdown() {
-  auto err = vkDeviceWaitIdle(device_);
-  check_vk_result(err);
-  ImGui_ImplVulkan_Shutdown();
-}
-
-void Vulkan::upload_fonts() {
-  // Use any command queue
-  auto* wd = &main_window_data_;
-  VkCommandPool command_pool = wd->Frames[wd->FrameIndex].CommandPool;
-  VkCommandBuffer command_buffer = wd->Frames[wd->FrameIndex].CommandBuffer;
-
-  auto err = vkResetCommandPool(device_, command_pool, 0);
-  check_vk_result(err);
-  VkCommandBufferBeginInfo begin_info{
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-      .flags = VkCommandBufferUsageFlags{} | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-  };
-  err = vkBeginCommandBuffer(command_buffer, &begin_info);
-  check_vk_result(err);
-
-  ImGui_ImplVulkan_CreateFontsTexture(command_buffer);
-
-  VkSubmitInfo end_info{
-      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-      .commandBufferCount = 1,
-      .pCommandBuffers = &command_buffer,
-  };
-  err = vkEndCommandBuffer(command_buffer);
-  check_vk_result(err);
-  err = vkQueueSubmit(queue_, 1, &end_info, nullptr);
-  check_vk_result(err);
-
-  err = vkDeviceWaitIdle(device_);
-  check_vk_result(err);
-  ImGui_ImplVulkan_DestroyFontUploadObjects();
-}
-
-void Vulkan::maybe_resize_swap_chain(SDL_Window* window) {
-  if (!swap_chain_rebuild_) { return; }
-  int width, height;
-  SDL_GetWindowSize(window, &width, &height);
-  if (width > 0 && height > 0) {
-    ImGui_ImplVulkan_SetMinImageCount(min_image_count_);
-    ImGui_ImplVulkanH_CreateOrResizeWindow(instance_, physical_device_, device_, &main_window_data_, queue_family_,
-                                           allocator_, width, height, min_image_count_);
-    main_window_data_.FrameIndex = 0;
-    swap_chain_rebuild_ = false;
-  }
-}
-
-void Vulkan::create_framebuffers(SDL_Window* window, VkSurfaceKHR surface) {
-  int w, h;
-  SDL_GetWindowSize(window, &w, &h);
-  setup_window(&main_window_data_, surface, w, h);
-}
-
-void Vulkan::create_surface(SDL_Window* window, VkSurfaceKHR* surface) {
-  if (SDL_Vulkan_CreateSurface(window, instance_, surface) == 0) [[unlikely]] {
-    throw_gui_error("Failed to create Vulkan surface: {}.", SDL_GetError());
-  }
-}
-
-void Vulkan::cleanup_window() { ImGui_ImplVulkanH_DestroyWindow(instance_, device_, &main_window_data_, allocator_); }
-
-Window::Window(std::string name, int width, int height) noexcept : name_(std::move(name)), size_({width, height}) {}
-
-Window::~Window() noexcept = default;
-
-void Window::show() {
-  // Setup window
-  constexpr static SDL_WindowFlags window_flags =
-      (SDL_WindowFlags)(SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
-  window_ =
-      SDL_CreateWindow(name_.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size_[0], size_[1], window_flags);
-  if (window_ == nullptr) [[unlikely]] {
-    throw_gui_error("Failed to create SDL window for '{}': {}", name_, SDL_GetError());
-  }
-
-  // Setup Vulkan
-  uint32_t extensions_count = 0;
-  SDL_Vulkan_GetInstanceExtensions(window_, &extensions_count, nullptr);
-  std::vector<char const*> extensions(extensions_count);
-  SDL_Vulkan_GetInstanceExtensions(window_, &extensions_count, extensions.data());
-  vulkan_ = std::make_unique<Vulkan>(extensions);
-
-  // Create Window Surface
-  VkSurfaceKHR surface;
-  vulkan_->create_surface(window_, &surface);
-
-  // Create Framebuffers
-  vulkan_->create_framebuffers(window_, surface);
-
-  // Setup Dear ImGui context
-  IMGUI_CHECKVERSION();
-  ImGui::CreateContext();
-  ImGuiIO& io [[maybe_unused]] = ImGui::GetIO();
-  // io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
-  // io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
-
-  // Setup Dear ImGui style
-  ImGui::StyleColorsDark();
-  // ImGui::StyleColorsClassic();
-
-  // Setup Platform/Renderer backends
-  vulkan_->init(window_);
-
-  // Load Fonts
-  // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use
-  // ImGui::PushFont()/PopFont() to select them.
-  // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
-  // - If the file cannot be loaded, the function will return NULL. Please handle those errors in your application (e.g.
-  // use an assertion, or display an error and quit).
-  // - The fonts will be rasterized at a given size (w/ oversampling) and stored into a texture when calling
-  // ImFontAtlas::Build()/GetTexDataAsXXXX(), which ImGui_ImplXXXX_NewFrame below will call.
-  // - Read 'docs/FONTS.md' for more instructions and details.
-  // - Remember that in C/C++ if you want to include a backslash \ in a string literal you need to write a double
-  // backslash \\ !
-  // io.Fonts->AddFontDefault();
-  // io.Fonts->AddFontFromFileTTF("../../misc/fonts/Roboto-Medium.ttf", 16.0f);
-  // io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
-  // io.Fonts->AddFontFromFileTTF("../../misc/fonts/DroidSans.ttf", 16.0f);
-  // io.Fonts->AddFontFromFileTTF("../../misc/fonts/ProggyTiny.ttf", 10.0f);
-  // ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL,
-  // io.Fonts->GetGlyphRangesJapanese()); IM_ASSERT(font != NULL);
-
-  // Upload Fonts
-  vulkan_->upload_fonts();
-
-  running_ = true;
-
-  // cleanup after we're done
-  scope_guard guard([this]() {
-    vulkan_->shutdown();
-    ImGui_ImplSDL2_Shutdown();
-    ImGui::DestroyContext();
-    vulkan_->cleanup_window();
-    vulkan_->cleanup();
-
-    SDL_DestroyWindow(window_);
-
-    window_ = nullptr;
-    vulkan_ = nullptr;
-  });
-
-  while (running_) { draw(); }
-}
-
-void Window::before_render_frame(ImGui_ImplVulkanH_Window* wd [[maybe_unused]],
-                                 ImDrawData* draw_data [[maybe_unused]]) {}
-
-void Window::draw() {
-  // Poll and handle events (inputs, window resize, etc.)
-  // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
-  // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite
-  // your copy of the mouse data.
-  // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or
-  // clear/overwrite your copy of the keyboard data. Generally you may always pass all inputs to dear imgui, and hide
-  // them from your application based on those two flags.
-  SDL_Event event;
-  while (SDL_PollEvent(&event)) {
-    ImGui_ImplSDL2_ProcessEvent(&event);
-    running_ =
-        event.type != SDL_QUIT && !(event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE &&
-                                    event.window.windowID == SDL_GetWindowID(window_));
-
-    if (!running_) { return; }
-  }
-
-  // Resize swap chain?
-  vulkan_->maybe_resize_swap_chain(window_);
-
-  // Start the Dear ImGui frame
-  ImGui_ImplVulkan_NewFrame();
-  ImGui_ImplSDL2_NewFrame();
-  ImGui::NewFrame();
-
-  on_gui();
-  if (!running_) { return; }
-
-  // Rendering
-  ImGui::Render();
-  ImDrawData* draw_data = ImGui::GetDrawData();
-  const bool is_minimized = (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f);
-  if (!is_minimized) [[likely]] {
-    auto* wd = &vulkan_->main_window_data();
-    before_render_frame(wd, draw_data);
-    vulkan_->render_frame(wd, draw_data);
-    vulkan_->present_frame(wd);
-  }
-}
-
-Application::Application(Window* window) : window_(window) {
-  // Setup SDL
-  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) [[unlikely]] {
-    throw_gui_error("Failed to initialize SDL2: {}\n", SDL_GetError());
-  }
-}
-
-Application::~Application() noexcept { SDL_Quit(); }
-
-auto Application::run() noexcept -> int {
-  if (window_ == nullptr) {
-    fmt::print(stderr, "No window given\n");
-    return -3;
-  }
-
-  try {
-    window_->show();
-    return 0;
-  } catch (GUIError const& e) {
-    fmt::print("{:s}({:d}) in {:s}:\n\t{:s}\n", e.source().file_name(), e.source().line(), e.source().function_name(),
-               e.what());
-    return e.error();
-  } catch (std::exception const& e) {
-    fmt::print("Exception caught: {:s}\n", e.what());
-    return -1;
-  } catch (...) {
-    fmt::print(stderr, "Unknown thrown object!\n");
-    return -2;
-  }
-}
-
-IMGUI_VK_NAMESPACE_END
+/**
+ * MIT License
+ *
+ * Copyright (c) 2022, Daumantas Kavolis
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "imgui_vulkan/imgui_vulkan.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <SDL.h>
+#include <SDL_vulkan.h>
+#include <fmt/core.h>
+#include <imgui_impl_sdl.h>
+#include <imgui_impl_vulkan.h>
+#include <vulkan/vulkan.h>
+
+IMGUI_VK_NAMESPACE_BEGIN
+
+#if defined(_MSC_VER)
+#  define IMGUI_VK_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__)
+#  define IMGUI_VK_NOINLINE __attribute__((noinline))
+#else
+#  define IMGUI_VK_NOINLINE
+#endif
+
+auto VKAPI_CALL debug_report(VkDebugReportFlagsEXT flags [[maybe_unused]], VkDebugReportObjectTypeEXT objectType,
+                             uint64_t object [[maybe_unused]], size_t location [[maybe_unused]],
+                             int32_t messageCode [[maybe_unused]], const char* pLayerPrefix [[maybe_unused]],
+                             const char* pMessage, void* pUserData) -> VkBool32 {
+  fmt::print(stderr, "[vulkan] Debug report from ObjectType: {}\nMessage: {}\n\n", objectType, pMessage);
+  return VK_FALSE;
+}
+
+template <class F>
+class scope_guard {
+ public:
+  explicit scope_guard(F f) noexcept : f_(std::move(f)) {}
+  ~scope_guard() noexcept { f_(); }
+
+ private:
+  F f_;
+};
+
+[[noreturn]] IMGUI_VK_NOINLINE static void vthrow_gui_error(
+    std::string const& msg, int code = -1, std::source_location src = std::source_location::current()) {
+  throw GUIError(msg, code, src);
+}
+
+[[noreturn]] IMGUI_VK_NOINLINE static void vthrow_gui_error(
+    char const* msg, int code = -1, std::source_location src = std::source_location::current()) {
+  throw GUIError(msg, code, src);
+}
+
+template <class... Args>
+struct FormatString {
+  using self = FormatString;
+
+  fmt::format_string<Args...> str;
+  std::source_location src;
+
+  consteval FormatString(fmt::format_string<Args...> fmt,
+                         std::source_location s = std::source_location::current()) noexcept
+      : str(fmt), src(s) {}
+
+  template <class S>
+    requires(std::constructible_from<fmt::format_string<Args...>, S> && !std::same_as<S, self>)
+  consteval FormatString(S const& fmt, std::source_location s = std::source_location::current()) noexcept
+      : str(fmt), src(s) {}
+};
+
+template <class... Args>
+[[noreturn]] void throw_gui_error(typename FormatString<Args...>::self fmt, Args&&... args) {
+  vthrow_gui_error(fmt::vformat(fmt.str, fmt::make_format_args(args...)), -1, fmt.src);
+}
+
+template <class... Args>
+[[noreturn]] void throw_gui_error(int code, typename FormatString<Args...>::self fmt, Args&&... args) {
+  vthrow_gui_error(fmt::vformat(fmt.str, fmt::make_format_args(args...)), code, fmt.src);
+}
+
+enum class TraceTrack : std::uint8_t {
+  // `TraceZone`s
+  zones,
+  // frame phases, on their own track since they don't nest inside the zones
+  phases,
+  // GPU time of frames moved onto the CPU clock
+  gpu,
+};
+
+struct TraceEvent {
+  std::string_view name;
+  // steady clock nanoseconds
+  std::int64_t begin = 0;
+  std::int64_t duration = 0;
+  // events left over from a previous recording are skipped when writing the trace
+  std::uint32_t session = 0;
+  TraceTrack track = TraceTrack::zones;
+};
+
+/**
+ * @brief Trace events of a single thread. Only the owning thread appends, the trace is written from the events up to
+ * the published size
+ */
+struct TraceBuffer {
+  constexpr static std::size_t capacity = std::size_t{1} << 16;
+
+  std::uint32_t thread = 0;
+  std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(capacity);
+  std::atomic<std::size_t> size = 0;
+  std::atomic<std::uint64_t> dropped = 0;
+};
+
+struct TraceRecorder {
+  std::atomic<bool> enabled = false;
+  std::atomic<std::uint32_t> session = 0;
+  // only locked by the first event of each thread, starting and stopping
+  std::mutex mutex;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  std::uint32_t threads = 0;
+};
+
+static auto trace_recorder() noexcept -> TraceRecorder& {
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+static auto trace_time(std::chrono::steady_clock::time_point time) noexcept -> std::int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+static auto thread_trace_buffer() noexcept -> TraceBuffer* {
+  // shared with the recorder so that the events outlive the thread
+  thread_local std::shared_ptr<TraceBuffer> buffer;
+  if (buffer == nullptr) {
+    try {
+      auto created = std::make_shared<TraceBuffer>();
+      auto& recorder = trace_recorder();
+      std::scoped_lock lock(recorder.mutex);
+      created->thread = ++recorder.threads;
+      recorder.buffers.push_back(created);
+      buffer = std::move(created);
+    } catch (std::bad_alloc const&) { return nullptr; }
+  }
+  return buffer.get();
+}
+
+static void record_trace_event(TraceTrack track, std::string_view name, std::int64_t begin,
+                               std::int64_t end) noexcept {
+  auto& recorder = trace_recorder();
+  if (!recorder.enabled.load(std::memory_order_relaxed)) return;
+  auto* buffer = thread_trace_buffer();
+  if (buffer == nullptr) return;
+
+  auto const index = buffer->size.load(std::memory_order_relaxed);
+  if (index >= TraceBuffer::capacity) {
+    buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer->events[index] = {
+      .name = name,
+      .begin = begin,
+      .duration = end - begin,
+      .session = recorder.session.load(std::memory_order_relaxed),
+      .track = track,
+  };
+  buffer->size.store(index + 1, std::memory_order_release);
+}
+
+auto TraceZone::begin() noexcept -> std::int64_t {
+  if (!trace_recorder().enabled.load(std::memory_order_relaxed)) return -1;
+  return trace_time(std::chrono::steady_clock::now());
+}
+
+void TraceZone::end(std::string_view name, std::int64_t begin) noexcept {
+  if (begin < 0) return;
+  record_trace_event(TraceTrack::zones, name, begin, trace_time(std::chrono::steady_clock::now()));
+}
+
+void start_tracing() noexcept {
+  if constexpr (build_config.tracing) {
+    auto& recorder = trace_recorder();
+    std::scoped_lock lock(recorder.mutex);
+    // buffers of exited threads are only referenced by the recorder
+    std::erase_if(recorder.buffers, [](auto const& buffer) { return buffer.use_count() == 1; });
+    for (auto const& buffer : recorder.buffers) {
+      buffer->size.store(0, std::memory_order_relaxed);
+      buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+    recorder.session.fetch_add(1, std::memory_order_relaxed);
+    recorder.enabled.store(true, std::memory_order_relaxed);
+  }
+}
+
+static void append_json_string(std::string& out, std::string_view str) {
+  out += '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') out += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20) out += c;
+  }
+  out += '"';
+}
+
+void stop_tracing(std::filesystem::path const& path) {
+  auto& recorder = trace_recorder();
+  recorder.enabled.store(false, std::memory_order_relaxed);
+
+  std::string out = R"({"displayTimeUnit": "ms", "traceEvents": [)";
+  auto inserter = std::back_inserter(out);
+  // each track is shown as a process with one thread per recording thread
+  constexpr std::array<std::string_view, 3> track_names{"zones", "frame phases", "GPU"};
+  for (std::size_t i = 0; i < track_names.size(); ++i) {
+    fmt::format_to(inserter, R"({}{{"name": "process_name", "ph": "M", "pid": {}, "args": {{"name": "{}"}}}})",
+                   i == 0 ? "" : ", ", i + 1, track_names[i]);
+  }
+
+  std::uint64_t dropped = 0;
+  {
+    std::scoped_lock lock(recorder.mutex);
+    auto const session = recorder.session.load(std::memory_order_relaxed);
+    for (auto const& buffer : recorder.buffers) {
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+      auto const size = std::min(buffer->size.load(std::memory_order_acquire), TraceBuffer::capacity);
+      for (std::size_t i = 0; i < size; ++i) {
+        auto const& event = buffer->events[i];
+        if (event.session != session) continue;
+        out += R"(, {"name": )";
+        append_json_string(out, event.name);
+        fmt::format_to(inserter, R"(, "ph": "X", "ts": {}.{:03}, "dur": {}.{:03}, "pid": {}, "tid": {}}})",
+                       event.begin / 1000, event.begin % 1000, event.duration / 1000, event.duration % 1000,
+                       static_cast<int>(event.track) + 1, buffer->thread);
+      }
+    }
+  }
+  out += "]}\n";
+  if (dropped > 0) fmt::print(stderr, "[trace] Dropped {} events that did not fit into the thread buffers\n", dropped);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+    throw_gui_error("Failed to write trace to {}", path.string());
+  }
+}
+
+// GPU timestamp queries are needed for both frame timings and GPU trace zones
+constexpr static bool gpu_timestamps = build_config.instrumentation || build_config.tracing;
+
+/**
+ * @brief Accumulates CPU time of consecutive frame phases, also recorded as trace zones while tracing
+ */
+class PhaseTimer {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit PhaseTimer(FrameTimings& timings) noexcept : timings_(&timings) {
+    if constexpr (enabled) {
+      start_ = clock::now();
+      last_ = start_;
+    }
+  }
+
+  /**
+   * @brief End the current phase, time since the previous mark is attributed to it
+   */
+  void mark(FramePhase phase) noexcept {
+    if constexpr (enabled) {
+      auto const now = clock::now();
+      if constexpr (build_config.instrumentation) {
+        timings_->cpu[static_cast<std::size_t>(phase)] += milliseconds(now - last_);
+      }
+      if constexpr (build_config.tracing) {
+        record_trace_event(TraceTrack::phases, frame_phase_name(phase), trace_time(last_), trace_time(now));
+      }
+      last_ = now;
+    }
+  }
+
+  // accumulates so that a frame can be timed on multiple threads
+  void finish() noexcept {
+    if constexpr (build_config.instrumentation) timings_->cpu_total += milliseconds(last_ - start_);
+  }
+
+  [[nodiscard]] auto timings() noexcept -> FrameTimings& { return *timings_; }
+
+ private:
+  constexpr static bool enabled = build_config.instrumentation || build_config.tracing;
+
+  FrameTimings* timings_;
+  clock::time_point start_;
+  clock::time_point last_;
+
+  [[nodiscard]] static auto milliseconds(clock::duration duration) noexcept -> float {
+    return std::chrono::duration<float, std::milli>(duration).count();
+  }
+};
+
+template <class T>
+static void copy_im_vector(ImVector<T>& dst, ImVector<T> const& src) {
+  // ImVector::operator= frees the old buffer, resizing keeps the capacity between frames
+  dst.resize(src.Size);
+  if (src.Size > 0) std::memcpy(dst.Data, src.Data, static_cast<std::size_t>(src.size_in_bytes()));
+}
+
+/**
+ * @brief Deep copy of a frame handed over to the render thread
+ */
+struct FrameSnapshot {
+  ImDrawData draw_data{};
+  // owned, reused between frames so that the buffers only grow
+  std::vector<ImDrawList*> draw_lists;
+  std::array<int, 2> size{};
+  PresentMode present_mode = PresentMode::fifo;
+  RenderScalePolicy render_scale;
+  bool skip_unchanged = false;
+  std::optional<std::chrono::steady_clock::time_point> input_time;
+  FrameTimings timings;
+
+  FrameSnapshot() noexcept = default;
+  FrameSnapshot(FrameSnapshot const&) = delete;
+  auto operator=(FrameSnapshot const&) -> FrameSnapshot& = delete;
+  ~FrameSnapshot() noexcept {
+    for (ImDrawList* list : draw_lists) IM_DELETE(list);
+  }
+
+  void copy(ImDrawData const& src) {
+    auto const count = static_cast<std::size_t>(src.CmdListsCount);
+    while (draw_lists.size() < count) {
+      draw_lists.push_back(IM_NEW(ImDrawList)(src.CmdLists[draw_lists.size()]->_Data));
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      ImDrawList const* from = src.CmdLists[i];
+      ImDrawList* to = draw_lists[i];
+      copy_im_vector(to->CmdBuffer, from->CmdBuffer);
+      copy_im_vector(to->IdxBuffer, from->IdxBuffer);
+      copy_im_vector(to->VtxBuffer, from->VtxBuffer);
+      to->Flags = from->Flags;
+    }
+
+    draw_data = src;
+    draw_data.CmdLists = draw_lists.data();
+  }
+};
+
+// 64 bit hash over 32 byte blocks in 4 independent lanes so that consecutive blocks don't wait on each other, not
+// meant to resist collisions on purpose
+static auto hash_bytes(void const* data, std::size_t size, std::uint64_t seed) noexcept -> std::uint64_t {
+  constexpr static std::uint64_t prime = 0x9E3779B97F4A7C15ull;
+  auto const* bytes = static_cast<std::byte const*>(data);
+  std::array<std::uint64_t, 4> lanes{seed, seed ^ prime, seed + prime, seed - prime};
+  auto mix_block = [&](std::byte const* block) {
+    for (std::size_t i = 0; i < lanes.size(); ++i) {
+      std::uint64_t word;
+      std::memcpy(&word, block + i * sizeof(word), sizeof(word));
+      lanes[i] = (lanes[i] ^ word) * prime;
+      lanes[i] ^= lanes[i] >> 29;
+    }
+  };
+
+  constexpr static std::size_t block_size = sizeof(lanes);
+  std::size_t offset = 0;
+  for (; offset + block_size <= size; offset += block_size) mix_block(bytes + offset);
+  if (offset < size) {
+    std::array<std::byte, block_size> tail{};
+    std::memcpy(tail.data(), bytes + offset, size - offset);
+    mix_block(tail.data());
+  }
+
+  std::uint64_t hash = size * prime;
+  for (auto lane : lanes) hash = (std::rotl(hash, 27) ^ lane) * prime;
+  return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief Hash of a frame for skipping frames identical to the last presented one, and per draw list hashes and
+ * framebuffer bounds to find the regions that changed
+ */
+struct DrawDataHash {
+  // display rectangle, framebuffer scale and clear color
+  std::uint64_t header = 0;
+  std::vector<std::uint64_t> lists;
+  std::vector<VkRectLayerKHR> bounds;
+
+  [[nodiscard]] auto operator==(DrawDataHash const& other) const noexcept -> bool {
+    return header == other.header && lists == other.lists;
+  }
+
+  // false if the draw data has user callbacks which may draw anything
+  [[nodiscard]] auto compute(ImDrawData const& draw_data, VkClearValue const& clear, VkExtent2D extent) -> bool {
+    struct Header {
+      ImVec2 position;
+      ImVec2 size;
+      ImVec2 scale;
+      VkClearValue clear;
+    } const header_data{draw_data.DisplayPos, draw_data.DisplaySize, draw_data.FramebufferScale, clear};
+    header = hash_bytes(&header_data, sizeof(header_data), 0);
+
+    auto const count = static_cast<std::size_t>(draw_data.CmdListsCount);
+    lists.resize(count);
+    bounds.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      ImDrawList const* list = draw_data.CmdLists[i];
+      auto hash = hash_bytes(list->VtxBuffer.Data, static_cast<std::size_t>(list->VtxBuffer.size_in_bytes()), i);
+      hash = hash_bytes(list->IdxBuffer.Data, static_cast<std::size_t>(list->IdxBuffer.size_in_bytes()), hash);
+
+      ImVec4 clip{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+      for (ImDrawCmd const& cmd : list->CmdBuffer) {
+        if (cmd.UserCallback != nullptr && cmd.UserCallback != ImDrawCallback_ResetRenderState) return false;
+        // only the fields that affect rendering, the struct has padding
+        struct Command {
+          ImVec4 clip_rect;
+          ImTextureID texture;
+          std::uint32_t vertex_offset;
+          std::uint32_t index_offset;
+          std::uint32_t element_count;
+          // explicit so that no padding bytes are hashed
+          std::uint32_t reserved;
+        } const command{cmd.ClipRect, cmd.GetTexID(), cmd.VtxOffset, cmd.IdxOffset, cmd.ElemCount, 0};
+        hash = hash_bytes(&command, sizeof(command), hash);
+        clip = {std::min(clip.x, cmd.ClipRect.x), std::min(clip.y, cmd.ClipRect.y), std::max(clip.z, cmd.ClipRect.z),
+                std::max(clip.w, cmd.ClipRect.w)};
+      }
+      lists[i] = hash;
+
+      // clip rectangles are in display coordinates, commands never draw outside of them
+      auto to_pixel = [](float value, float origin, float scale, std::uint32_t limit) {
+        return static_cast<std::int32_t>(std::clamp((value - origin) * scale, 0.0f, static_cast<float>(limit)));
+      };
+      auto const x0 = to_pixel(clip.x, draw_data.DisplayPos.x, draw_data.FramebufferScale.x, extent.width);
+      auto const y0 = to_pixel(clip.y, draw_data.DisplayPos.y, draw_data.FramebufferScale.y, extent.height);
+      auto const x1 = to_pixel(clip.z, draw_data.DisplayPos.x, draw_data.FramebufferScale.x, extent.width);
+      auto const y1 = to_pixel(clip.w, draw_data.DisplayPos.y, draw_data.FramebufferScale.y, extent.height);
+      bounds[i] = {
+          .offset = {x0, y0},
+          .extent = {static_cast<std::uint32_t>(std::max(x1 - x0, 0)),
+                     static_cast<std::uint32_t>(std::max(y1 - y0, 0))},
+      };
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Renders frame snapshots produced by the UI thread, triple buffered
+ */
+class RenderThread {
+ public:
+  using RenderFn = std::function<void(FrameSnapshot&)>;
+
+  explicit RenderThread(RenderFn render) : render_(std::move(render)) {
+    for (std::size_t i = 0; i < snapshots_.size(); ++i) free_.push_back(i);
+    thread_ = std::thread([this]() { run(); });
+  }
+
+  RenderThread(RenderThread const&) = delete;
+  auto operator=(RenderThread const&) -> RenderThread& = delete;
+
+  // renders any pending frames before joining
+  ~RenderThread() noexcept {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+  }
+
+  /**
+   * @brief Get a snapshot to fill in, blocks while another frame is already waiting to be rendered
+   * @throws Any exception thrown on the render thread
+   */
+  [[nodiscard]] auto acquire() -> FrameSnapshot& {
+    std::unique_lock lock(mutex_);
+    condition_.wait(lock, [this]() { return error_ != nullptr || (pending_.empty() && !free_.empty()); });
+    if (error_ != nullptr) std::rethrow_exception(error_);
+    auto const index = free_.back();
+    free_.pop_back();
+    return snapshots_[index];
+  }
+
+  /**
+   * @brief Queue the acquired snapshot for rendering
+   */
+  void publish(FrameSnapshot& snapshot) {
+    {
+      std::lock_guard lock(mutex_);
+      pending_.push_back(static_cast<std::size_t>(&snapshot - snapshots_.data()));
+    }
+    condition_.notify_all();
+  }
+
+  /**
+   * @brief Wait until all published frames have been rendered
+   * @throws Any exception thrown on the render thread
+   */
+  void flush() {
+    std::unique_lock lock(mutex_);
+    condition_.wait(lock, [this]() { return error_ != nullptr || free_.size() == snapshots_.size(); });
+    if (error_ != nullptr) std::rethrow_exception(error_);
+  }
+
+ private:
+  RenderFn render_;
+  std::array<FrameSnapshot, 3> snapshots_;
+  std::vector<std::size_t> free_;
+  std::deque<std::size_t> pending_;
+  std::exception_ptr error_;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::thread thread_;
+
+  // render thread
+  void run() noexcept {
+    while (true) {
+      std::size_t index;
+      {
+        std::unique_lock lock(mutex_);
+        condition_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) return;
+        index = pending_.front();
+        pending_.pop_front();
+      }
+
+      std::exception_ptr error;
+      try {
+        render_(snapshots_[index]);
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard lock(mutex_);
+        free_.push_back(index);
+        // stop rendering after the first error, the UI thread rethrows it
+        if (error != nullptr) {
+          error_ = error;
+          pending_.clear();
+        }
+      }
+      condition_.notify_all();
+      if (error != nullptr) return;
+    }
+  }
+};
+
+/**
+ * @brief Threads that run the jobs of a batch in parallel with the calling thread, which always takes the first job
+ */
+class RecordingWorkers {
+ public:
+  using Job = std::function<void(std::uint32_t)>;
+
+  explicit RecordingWorkers(std::uint32_t threads) {
+    for (std::uint32_t i = 0; i < threads; ++i) threads_.emplace_back([this, i]() { work(i + 1); });
+  }
+
+  RecordingWorkers(RecordingWorkers const&) = delete;
+  auto operator=(RecordingWorkers const&) -> RecordingWorkers& = delete;
+
+  ~RecordingWorkers() noexcept {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+  // maximum number of jobs in a batch
+  [[nodiscard]] auto size() const noexcept -> std::uint32_t { return static_cast<std::uint32_t>(threads_.size()) + 1; }
+
+  /**
+   * @brief Run `job(i)` for all i < count and wait for all of them to finish, count must not exceed `size()`
+   * @throws The first exception thrown by a job
+   */
+  void run(std::uint32_t count, Job const& job) {
+    {
+      std::lock_guard lock(mutex_);
+      job_ = &job;
+      count_ = count;
+      running_ = threads_.size();
+      error_ = nullptr;
+      ++batch_;
+    }
+    start_.notify_all();
+
+    std::exception_ptr error;
+    try {
+      job(0);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this]() { return running_ == 0; });
+    job_ = nullptr;
+    if (error == nullptr) error = error_;
+    if (error != nullptr) std::rethrow_exception(error);
+  }
+
+ private:
+  std::vector<std::thread> threads_;
+  Job const* job_ = nullptr;
+  std::uint32_t count_ = 0;
+  // threads that have not finished the current batch
+  std::size_t running_ = 0;
+  std::uint64_t batch_ = 0;
+  std::exception_ptr error_;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+
+  // worker thread
+  void work(std::uint32_t index) noexcept {
+    std::uint64_t batch = 0;
+    while (true) {
+      Job const* job;
+      {
+        std::unique_lock lock(mutex_);
+        start_.wait(lock, [&]() { return stop_ || batch_ != batch; });
+        if (stop_) return;
+        batch = batch_;
+        job = index < count_ ? job_ : nullptr;
+      }
+
+      std::exception_ptr error;
+      if (job != nullptr) {
+        try {
+          (*job)(index);
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+
+      {
+        std::lock_guard lock(mutex_);
+        if (error_ == nullptr) error_ = error;
+        --running_;
+      }
+      done_.notify_one();
+    }
+  }
+};
+
+/**
+ * @brief Vulkan host memory allocator with size class pools and an arena for command scope allocations
+ */
+class HostAllocator {
+ public:
+  explicit HostAllocator(HostAllocatorOptions const& options);
+  HostAllocator(HostAllocator const&) = delete;
+  auto operator=(HostAllocator const&) -> HostAllocator& = delete;
+  ~HostAllocator() noexcept;
+
+  [[nodiscard]] auto callbacks() const noexcept -> VkAllocationCallbacks const* { return &callbacks_; }
+  [[nodiscard]] auto stats() const noexcept -> HostMemoryStats;
+  void end_frame() noexcept;
+
+ private:
+  // precedes every allocation
+  struct alignas(16) Header {
+    std::uint32_t size_class;
+    // from the start of the block
+    std::uint32_t offset;
+    std::size_t size;
+  };
+  static_assert(sizeof(Header) == 16);
+  constexpr static std::size_t block_alignment = alignof(Header);
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // 32 B to 4 KiB blocks carved out of 64 KiB chunks
+  constexpr static std::uint32_t min_class_shift = 5;
+  constexpr static std::uint32_t class_count = 8;
+  constexpr static std::uint32_t large_class = class_count;
+  constexpr static std::uint32_t arena_class = class_count + 1;
+  constexpr static std::size_t max_class_size = std::size_t{1} << (min_class_shift + class_count - 1);
+  constexpr static std::size_t chunk_size = 64 * 1024;
+
+  VkAllocationCallbacks callbacks_;
+  std::size_t max_bytes_;
+
+  std::mutex mutex_;
+  std::array<FreeBlock*, class_count> free_{};
+  std::vector<void*> chunks_;
+  std::byte* arena_ = nullptr;
+  std::size_t arena_size_;
+  std::size_t arena_offset_ = 0;
+  std::size_t arena_live_ = 0;
+
+  std::atomic<std::size_t> bytes_live_ = 0;
+  std::atomic<std::size_t> bytes_peak_ = 0;
+  std::atomic<std::size_t> bytes_reserved_ = 0;
+  std::atomic<std::size_t> bytes_internal_ = 0;
+  std::atomic<std::uint64_t> allocations_ = 0;
+  std::atomic<std::uint64_t> frame_allocations_ = 0;
+  std::atomic<std::uint64_t> allocations_last_frame_ = 0;
+  std::atomic<std::uint64_t> arena_allocations_ = 0;
+  std::atomic<std::uint64_t> failed_allocations_ = 0;
+
+  [[nodiscard]] auto allocate(std::size_t size, std::size_t alignment, VkSystemAllocationScope scope) noexcept
+      -> void*;
+  [[nodiscard]] auto reallocate(void* original, std::size_t size, std::size_t alignment,
+                                VkSystemAllocationScope scope) noexcept -> void*;
+  void free(void* memory) noexcept;
+  [[nodiscard]] auto pop_block(std::uint32_t size_class) noexcept -> std::byte*;
+
+  static auto VKAPI_CALL allocation_fn(void* user_data, std::size_t size, std::size_t alignment,
+                                       VkSystemAllocationScope scope) -> void* {
+    return static_cast<HostAllocator*>(user_data)->allocate(size, alignment, scope);
+  }
+  static auto VKAPI_CALL reallocation_fn(void* user_data, void* original, std::size_t size, std::size_t alignment,
+                                         VkSystemAllocationScope scope) -> void* {
+    return static_cast<HostAllocator*>(user_data)->reallocate(original, size, alignment, scope);
+  }
+  static void VKAPI_CALL free_fn(void* user_data, void* memory) {
+    static_cast<HostAllocator*>(user_data)->free(memory);
+  }
+  static void VKAPI_CALL internal_allocation_fn(void* user_data, std::size_t size, VkInternalAllocationType /*type*/,
+                                                VkSystemAllocationScope /*scope*/) {
+    static_cast<HostAllocator*>(user_data)->bytes_internal_ += size;
+  }
+  static void VKAPI_CALL internal_free_fn(void* user_data, std::size_t size, VkInternalAllocationType /*type*/,
+                                          VkSystemAllocationScope /*scope*/) {
+    static_cast<HostAllocator*>(user_data)->bytes_internal_ -= size;
+  }
+
+  [[nodiscard]] static auto header(void* memory) noexcept -> Header* {
+    return reinterpret_cast<Header*>(static_cast<std::byte*>(memory) - sizeof(Header));
+  }
+  [[nodiscard]] static constexpr auto class_size(std::uint32_t size_class) noexcept -> std::size_t {
+    return std::size_t{1} << (min_class_shift + size_class);
+  }
+};
+
+HostAllocator::HostAllocator(HostAllocatorOptions const& options)
+    : callbacks_{
+          .pUserData = this,
+          .pfnAllocation = allocation_fn,
+          .pfnReallocation = reallocation_fn,
+          .pfnFree = free_fn,
+          .pfnInternalAllocation = internal_allocation_fn,
+          .pfnInternalFree = internal_free_fn,
+      },
+      max_bytes_(options.max_bytes),
+      arena_size_(options.arena_size & ~(block_alignment - 1)) {
+  if (arena_size_ > 0) {
+    arena_ = static_cast<std::byte*>(::operator new(arena_size_, std::align_val_t{block_alignment}));
+    bytes_reserved_ = arena_size_;
+  }
+}
+
+HostAllocator::~HostAllocator() noexcept {
+  for (void* chunk : chunks_) ::operator delete(chunk, std::align_val_t{block_alignment});
+  if (arena_ != nullptr) ::operator delete(arena_, std::align_val_t{block_alignment});
+}
+
+auto HostAllocator::stats() const noexcept -> HostMemoryStats {
+  return {
+      .bytes_live = bytes_live_.load(std::memory_order_relaxed),
+      .bytes_peak = bytes_peak_.load(std::memory_order_relaxed),
+      .bytes_reserved = bytes_reserved_.load(std::memory_order_relaxed),
+      .bytes_internal = bytes_internal_.load(std::memory_order_relaxed),
+      .allocations = allocations_.load(std::memory_order_relaxed),
+      .allocations_last_frame = allocations_last_frame_.load(std::memory_order_relaxed),
+      .arena_allocations = arena_allocations_.load(std::memory_order_relaxed),
+      .failed_allocations = failed_allocations_.load(std::memory_order_relaxed),
+  };
+}
+
+void HostAllocator::end_frame() noexcept {
+  allocations_last_frame_.store(frame_allocations_.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+auto HostAllocator::pop_block(std::uint32_t size_class) noexcept -> std::byte* {
+  if (free_[size_class] == nullptr) {
+    // refill the free list with a new chunk, chunks are only released with the allocator
+    void* chunk = ::operator new(chunk_size, std::align_val_t{block_alignment}, std::nothrow);
+    if (chunk == nullptr) return nullptr;
+    try {
+      chunks_.push_back(chunk);
+    } catch (...) {
+      ::operator delete(chunk, std::align_val_t{block_alignment});
+      return nullptr;
+    }
+    bytes_reserved_ += chunk_size;
+
+    auto const block_size = class_size(size_class);
+    auto* bytes = static_cast<std::byte*>(chunk);
+    for (std::size_t offset = chunk_size; offset >= block_size; offset -= block_size) {
+      auto* block = reinterpret_cast<FreeBlock*>(bytes + offset - block_size);
+      block->next = free_[size_class];
+      free_[size_class] = block;
+    }
+  }
+
+  FreeBlock* block = free_[size_class];
+  free_[size_class] = block->next;
+  return reinterpret_cast<std::byte*>(block);
+}
+
+auto HostAllocator::allocate(std::size_t size, std::size_t alignment, VkSystemAllocationScope scope) noexcept
+    -> void* {
+  if (size == 0) return nullptr;
+  if (max_bytes_ > 0 && bytes_live_.load(std::memory_order_relaxed) + size > max_bytes_) {
+    ++failed_allocations_;
+    return nullptr;
+  }
+
+  // alignments are powers of 2, blocks are always aligned to the header size
+  alignment = std::max(alignment, block_alignment);
+  auto const needed = size + sizeof(Header) + (alignment - block_alignment);
+
+  std::byte* block = nullptr;
+  std::uint32_t size_class;
+  {
+    std::lock_guard lock(mutex_);
+    if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND && arena_offset_ + needed <= arena_size_) {
+      // freed before the Vulkan command returns
+      block = arena_ + arena_offset_;
+      arena_offset_ += (needed + block_alignment - 1) & ~(block_alignment - 1);
+      ++arena_live_;
+      size_class = arena_class;
+      ++arena_allocations_;
+    } else if (needed <= max_class_size) {
+      size_class = std::max(static_cast<std::uint32_t>(std::bit_width(needed - 1)), min_class_shift) - min_class_shift;
+      block = pop_block(size_class);
+    } else {
+      size_class = large_class;
+      block = static_cast<std::byte*>(::operator new(needed, std::align_val_t{block_alignment}, std::nothrow));
+    }
+  }
+  if (block == nullptr) [[unlikely]] {
+    ++failed_allocations_;
+    return nullptr;
+  }
+
+  auto const address = reinterpret_cast<std::uintptr_t>(block + sizeof(Header));
+  auto* memory = block + sizeof(Header) + ((alignment - address % alignment) % alignment);
+  *header(memory) = {
+      .size_class = size_class,
+      .offset = static_cast<std::uint32_t>(memory - block),
+      .size = size,
+  };
+  // unused alignment slack at the end of large allocations is not counted so that free can recompute it
+  if (size_class == large_class) bytes_reserved_ += size + static_cast<std::size_t>(memory - block);
+
+  auto const live = bytes_live_.fetch_add(size, std::memory_order_relaxed) + size;
+  auto peak = bytes_peak_.load(std::memory_order_relaxed);
+  while (live > peak && !bytes_peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+  ++allocations_;
+  ++frame_allocations_;
+  return memory;
+}
+
+auto HostAllocator::reallocate(void* original, std::size_t size, std::size_t alignment,
+                               VkSystemAllocationScope scope) noexcept -> void* {
+  if (original == nullptr) return allocate(size, alignment, scope);
+  if (size == 0) {
+    free(original);
+    return nullptr;
+  }
+
+  // grow or shrink in place if the block is large enough
+  Header* info = header(original);
+  if (info->size_class < class_count && reinterpret_cast<std::uintptr_t>(original) % alignment == 0 &&
+      size <= class_size(info->size_class) - info->offset) {
+    if (size > info->size) {
+      if (max_bytes_ > 0 && bytes_live_.load(std::memory_order_relaxed) + (size - info->size) > max_bytes_) {
+        ++failed_allocations_;
+        return nullptr;
+      }
+      bytes_live_ += size - info->size;
+    } else {
+      bytes_live_ -= info->size - size;
+    }
+    info->size = size;
+    return original;
+  }
+
+  void* memory = allocate(size, alignment, scope);
+  // the original allocation has to stay valid on failure
+  if (memory == nullptr) return nullptr;
+  std::memcpy(memory, original, std::min(size, info->size));
+  free(original);
+  return memory;
+}
+
+void HostAllocator::free(void* memory) noexcept {
+  if (memory == nullptr) return;
+  Header const info = *header(memory);
+  auto* block = static_cast<std::byte*>(memory) - info.offset;
+  bytes_live_ -= info.size;
+
+  if (info.size_class == large_class) {
+    bytes_reserved_ -= info.size + info.offset;
+    ::operator delete(block, std::align_val_t{block_alignment});
+    return;
+  }
+
+  std::lock_guard lock(mutex_);
+  if (info.size_class == arena_class) {
+    // the arena starts over once all transient allocations have been freed
+    if (--arena_live_ == 0) arena_offset_ = 0;
+    return;
+  }
+  auto* free_block = reinterpret_cast<FreeBlock*>(block);
+  free_block->next = free_[info.size_class];
+  free_[info.size_class] = free_block;
+}
+
+/**
+ * @brief Persistently mapped staging buffer sub-allocated in FIFO order. Positions increase monotonically and wrap
+ * around the buffer, space up to a position is released once the frame that copied from it has completed on the GPU
+ */
+struct StagingRing {
+  VkBuffer buffer = nullptr;
+  VkDeviceMemory memory = nullptr;
+  std::byte* mapped = nullptr;
+  // multiple of the allocation alignment
+  VkDeviceSize size = 0;
+  std::uint64_t head = 0;
+  std::uint64_t tail = 0;
+
+  // offset into the buffer, nullopt if there's not enough free space
+  [[nodiscard]] auto allocate(VkDeviceSize bytes, VkDeviceSize alignment) noexcept -> std::optional<VkDeviceSize> {
+    if (bytes > size) return std::nullopt;
+    auto position = (head + alignment - 1) / alignment * alignment;
+    // allocations never wrap around the end of the buffer
+    if (position % size + bytes > size) position = (position / size + 1) * size;
+    if (position + bytes - tail > size) return std::nullopt;
+    head = position + bytes;
+    return position % size;
+  }
+
+  void release(std::uint64_t position) noexcept { tail = std::max(tail, position); }
+};
+
+/**
+ * @brief Texture descriptor sets allocated from a chain of pools that starts small and grows on demand. Freed sets are
+ * kept for reuse instead of being returned to their pool so the pools never fragment
+ */
+class DescriptorAllocator {
+ public:
+  constexpr static std::uint32_t initial_pool_sets = 16;
+  constexpr static std::uint32_t max_pool_sets = 1024;
+
+  void create(VkDevice device, VkAllocationCallbacks const* allocator);
+  void destroy() noexcept;
+  [[nodiscard]] auto allocate() -> VkDescriptorSet;
+  // the set must no longer be in use by the GPU
+  void free(VkDescriptorSet set);
+  [[nodiscard]] auto stats() const noexcept -> DescriptorStats;
+  [[nodiscard]] auto layout() const noexcept -> VkDescriptorSetLayout { return layout_; }
+
+ private:
+  VkDevice device_ = nullptr;
+  VkAllocationCallbacks const* allocator_ = nullptr;
+  // the pipeline layout of every window is created with it, sets allocated by the ImGui backend use its own private
+  // layout and are never bound
+  VkDescriptorSetLayout layout_ = nullptr;
+  std::vector<VkDescriptorPool> pools_;
+  std::vector<VkDescriptorSet> free_sets_;
+  std::uint32_t last_pool_sets_ = 0;
+  DescriptorStats stats_;
+
+  void add_pool();
+};
+
+// device level functions called every frame
+#define IMGUI_VK_DEVICE_FUNCTIONS(X) \
+  X(vkAcquireNextImageKHR)           \
+  X(vkQueuePresentKHR)               \
+  X(vkQueueSubmit)                   \
+  X(vkWaitForFences)                 \
+  X(vkResetFences)                   \
+  X(vkResetCommandPool)              \
+  X(vkBeginCommandBuffer)            \
+  X(vkEndCommandBuffer)              \
+  X(vkCmdBeginRenderPass)            \
+  X(vkCmdEndRenderPass)              \
+  X(vkCmdBindPipeline)               \
+  X(vkCmdBindDescriptorSets)         \
+  X(vkCmdBindVertexBuffers)          \
+  X(vkCmdBindIndexBuffer)            \
+  X(vkCmdSetViewport)                \
+  X(vkCmdSetScissor)                 \
+  X(vkCmdPushConstants)              \
+  X(vkCmdDrawIndexed)                \
+  X(vkCmdExecuteCommands)            \
+  X(vkCmdWriteTimestamp)             \
+  X(vkCmdResetQueryPool)             \
+  X(vkCmdPipelineBarrier)            \
+  X(vkCmdCopyBufferToImage)          \
+  X(vkCmdCopyImageToBuffer)          \
+  X(vkCmdBlitImage)                  \
+  X(vkInvalidateMappedMemoryRanges)  \
+  X(vkGetQueryPoolResults)
+
+/**
+ * @brief Device functions of the frame loop loaded with vkGetDeviceProcAddr, calling them skips the dispatch
+ * trampoline of the loader
+ */
+struct DeviceDispatch {
+#define IMGUI_VK_DECLARE_FUNCTION(name) PFN_##name name = nullptr;
+  IMGUI_VK_DEVICE_FUNCTIONS(IMGUI_VK_DECLARE_FUNCTION)
+#undef IMGUI_VK_DECLARE_FUNCTION
+  // VK_KHR_timeline_semaphore, null if it is not enabled
+  PFN_vkWaitSemaphores vkWaitSemaphores = nullptr;
+  PFN_vkGetSemaphoreCounterValue vkGetSemaphoreCounterValue = nullptr;
+
+  void load(VkDevice device) noexcept {
+    // functions of extensions that aren't enabled, e.g. the swap chain without a window, keep the loader's version
+#define IMGUI_VK_LOAD_FUNCTION(name)                                       \
+  name = reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr(device, #name)); \
+  if (name == nullptr) name = &::name;
+    IMGUI_VK_DEVICE_FUNCTIONS(IMGUI_VK_LOAD_FUNCTION)
+#undef IMGUI_VK_LOAD_FUNCTION
+  }
+
+  // the extension entry points keep their suffix on 1.1 devices
+  [[nodiscard]] auto load_timeline_semaphore(VkDevice device) noexcept -> bool {
+    vkWaitSemaphores = reinterpret_cast<PFN_vkWaitSemaphores>(vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR"));
+    vkGetSemaphoreCounterValue = reinterpret_cast<PFN_vkGetSemaphoreCounterValue>(
+        vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR"));
+    if (vkWaitSemaphores != nullptr && vkGetSemaphoreCounterValue != nullptr) return true;
+    vkWaitSemaphores = nullptr;
+    vkGetSemaphoreCounterValue = nullptr;
+    return false;
+  }
+};
+
+/**
+ * @brief Vulkan instance, device and the objects shared by all windows of an application
+ */
+class Device {
+ public:
+  Device(std::span<char const* const> extensions, SDL_Window* window, VkAllocationCallbacks const* allocator,
+         std::shared_ptr<HostAllocator> host_allocator, GpuSelection const& selection);
+  Device(Device const&) = delete;
+  auto operator=(Device const&) -> Device& = delete;
+  ~Device() noexcept;
+
+  void create_pipeline_cache(std::filesystem::path const& directory);
+  void save_pipeline_cache() noexcept;
+
+ private:
+  VkAllocationCallbacks const* allocator_ = nullptr;
+  // keeps the allocator behind `allocator_` alive for as long as any window uses the device
+  std::shared_ptr<HostAllocator> host_allocator_;
+  VkInstance instance_ = nullptr;
+  VkPhysicalDevice physical_device_ = nullptr;
+  VkDevice device_ = nullptr;
+  std::uint32_t queue_family_ = std::numeric_limits<std::uint32_t>::max();
+  VkQueue queue_ = nullptr;
+  // the queues have to be externally synchronized between render threads of different windows, vkDeviceWaitIdle
+  // included
+  std::mutex queue_mutex_;
+  // only set if the device has a transfer only queue family
+  std::uint32_t transfer_queue_family_ = std::numeric_limits<std::uint32_t>::max();
+  VkQueue transfer_queue_ = nullptr;
+  // textures of all windows are allocated from and freed to the same pools
+  std::mutex descriptor_pool_mutex_;
+  DescriptorAllocator descriptors_;
+  VkDebugReportCallbackEXT debug_report_ = nullptr;
+  VkPipelineCache pipeline_cache_ = nullptr;
+  std::filesystem::path pipeline_cache_path_;
+  std::uint32_t timestamp_valid_bits_ = 0;
+  float timestamp_period_ = 0;
+  // instance level API version, capped to the highest version the code knows about
+  std::uint32_t api_version_ = VK_API_VERSION_1_0;
+  // VK_KHR_incremental_present is enabled
+  bool incremental_present_ = false;
+  // VK_KHR_present_id and VK_KHR_present_wait are enabled
+  bool present_wait_ = false;
+  PFN_vkWaitForPresentKHR wait_for_present_ = nullptr;
+  // VK_KHR_timeline_semaphore is enabled, frames are tracked with a timeline instead of fences
+  bool timeline_semaphore_ = false;
+  DeviceDispatch dispatch_;
+  DeviceInfo info_;
+  bool headless_ = false;
+
+  void select_physical_device(VkSurfaceKHR surface, GpuSelection const& selection);
+
+  friend class Vulkan;
+};
+
+/**
+ * @brief Per window Vulkan state: swap chain or offscreen targets and frames in flight
+ */
+class Vulkan {
+ public:
+  explicit Vulkan(std::shared_ptr<Device> device);
+
+  void setup_window(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface, int width, int height);
+  void init(SDL_Window* window);
+  void cleanup();
+  void cleanup_window();
+  void render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data, PhaseTimer& timer);
+  void present_frame(ImGui_ImplVulkanH_Window* wd, PhaseTimer& timer);
+  void create_surface(SDL_Window* wd, VkSurfaceKHR* surface);
+  void create_framebuffers(SDL_Window* wd, VkSurfaceKHR surface);
+  void create_offscreen(int width, int height, std::uint32_t image_count);
+  void create_frame_contexts(std::uint32_t count);
+  void create_staging_ring(std::size_t size);
+  void create_geometry_ring(bool device_local);
+  void set_parallel_recording(ParallelRecording const& options);
+  // caps the sample count to the device limits and returns it, before the framebuffers or offscreen targets are made
+  auto set_msaa_samples(std::uint32_t samples) -> std::uint32_t;
+  void wait_idle();
+  void shutdown();
+  void upload_fonts(ImFontAtlas& fonts);
+  // starts a backend frame, ImGui draws are only ever recorded with the pipeline layout of this class
+  void new_frame();
+  // creates the pipeline of the main window on a worker thread, the first frame waits for it
+  void build_pipeline(std::atomic<float>& milliseconds);
+  [[nodiscard]] auto upload_texture(std::span<std::uint8_t const> rgba, int width, int height) -> ImTextureID;
+  void destroy_texture(ImTextureID texture);
+  // the main window image of every frame or only the next one is copied into host memory at the end of the frame
+  void set_frame_capture(bool enable) noexcept;
+  void capture_next_frame() noexcept;
+  void set_capture_handler(std::function<void(FrameCapture const&)> handler);
+  // hands the captures of completed frames to the handler in frame order
+  void deliver_captures();
+  void maybe_resize_swap_chain(int width, int height);
+  void set_present_mode(PresentMode mode) noexcept;
+  void set_render_scale_policy(RenderScalePolicy const& policy) noexcept;
+  // waits until the frame the next render_frame recycles has been displayed, or at least rendered
+  void wait_for_frame();
+  // number of submitted frames the GPU has finished, resources used by older frames can be reused
+  [[nodiscard]] auto completed_frames() -> std::uint64_t;
+  // blocks until at least the first `count` submitted frames have finished on the GPU
+  void wait_for_frames(std::uint64_t count);
+  // true if the frame is identical to the last presented one, otherwise it becomes the last presented frame
+  [[nodiscard]] auto frame_unchanged(ImGui_ImplVulkanH_Window const* wd, ImDrawData const* draw_data) -> bool;
+  // creates, resizes and destroys the OS windows of ImGui viewports, after ImGui::Render
+  void update_viewports();
+
+  [[nodiscard]] auto main_window_data() const noexcept -> ImGui_ImplVulkanH_Window const&;
+  [[nodiscard]] auto main_window_data() noexcept -> ImGui_ImplVulkanH_Window&;
+  [[nodiscard]] auto device_info() const noexcept -> DeviceInfo const&;
+  [[nodiscard]] auto descriptor_stats() -> DescriptorStats;
+
+ private:
+  std::shared_ptr<Device> shared_device_;
+  // borrowed from the shared device
+  VkAllocationCallbacks const* allocator_;
+  VkInstance instance_;
+  VkPhysicalDevice physical_device_;
+  VkDevice device_;
+  std::uint32_t queue_family_;
+  VkQueue queue_;
+  std::uint32_t transfer_queue_family_;
+  VkQueue transfer_queue_;
+  VkPipelineCache pipeline_cache_;
+  // device functions used while recording, submitting and presenting frames
+  DeviceDispatch const* vk_;
+  bool headless_;
+  // only holds the descriptor set the ImGui backend allocates for itself
+  VkDescriptorPool backend_descriptor_pool_ = nullptr;
+
+  ImGui_ImplVulkanH_Window main_window_data_;
+  std::uint32_t min_image_count_ = 2;
+  VkPresentModeKHR present_mode_ = VK_PRESENT_MODE_FIFO_KHR;
+  bool swap_chain_rebuild_ = false;
+
+  // last presented frame and the regions the next present changes, empty if everything may have changed
+  constexpr static std::size_t max_damage_rects = 16;
+  bool incremental_present_;
+  DrawDataHash presented_hash_;
+  DrawDataHash frame_hash_;
+  bool presented_hash_valid_ = false;
+  // the frame being rendered went through frame_unchanged
+  bool frame_hashed_ = false;
+  std::vector<VkRectLayerKHR> damage_;
+
+  // null without VK_KHR_present_wait, ids are only given to the main window presents
+  PFN_vkWaitForPresentKHR wait_for_present_;
+  std::uint64_t present_id_ = 0;
+  std::vector<std::uint64_t> present_ids_;
+
+  // reused between frames, the main window comes first
+  std::vector<VkSemaphore> submit_waits_;
+  std::vector<VkPipelineStageFlags> submit_wait_stages_;
+  std::vector<VkSemaphore> submit_signals_;
+  std::vector<VkSemaphore> present_waits_;
+  std::vector<VkSwapchainKHR> present_swapchains_;
+  std::vector<std::uint32_t> present_images_;
+  std::vector<VkPresentRegionKHR> present_regions_;
+  std::vector<VkResult> present_results_;
+
+  // host copy of a captured frame, preferably in cached memory since it is read by the CPU
+  struct Readback {
+    VkBuffer buffer = nullptr;
+    VkDeviceMemory memory = nullptr;
+    std::byte const* mapped = nullptr;
+    VkDeviceSize size = 0;
+    bool coherent = false;
+    // set while a copy is in flight
+    bool pending = false;
+    FrameCapture capture;
+  };
+
+  // resources of a frame in flight, cycled by frame counter independently of the swap chain images
+  struct FrameContext {
+    VkCommandPool command_pool = nullptr;
+    VkCommandBuffer command_buffer = nullptr;
+    // null when frames are tracked with the timeline semaphore
+    VkFence fence = nullptr;
+    VkSemaphore image_acquired = nullptr;
+    // uploads on the transfer queue, the graphics submission waits for them so completing the frame covers both
+    VkCommandPool transfer_command_pool = nullptr;
+    VkCommandBuffer transfer_command_buffer = nullptr;
+    VkSemaphore transfer_complete = nullptr;
+    // geometry ring position released once the frame has completed
+    std::uint64_t geometry_end = 0;
+    // id the frame was presented with on the current swap chain, 0 if it hasn't been presented
+    std::uint64_t present_id = 0;
+    // steady clock nanoseconds, places the GPU trace zone of the frame
+    std::int64_t submit_time = 0;
+    // scale the frame was rendered at, relates its GPU time to the next scale
+    float render_scale = 1;
+    // the capture completes with the frame so each frame in flight has its own buffer, grown on demand
+    Readback readback;
+    // one pool per recording thread since pools can't be used concurrently, created on first parallel recording
+    std::vector<VkCommandPool> secondary_pools;
+    std::vector<VkCommandBuffer> secondary_command_buffers;
+  };
+  std::vector<FrameContext> frames_;
+  std::uint64_t frame_counter_ = 0;
+  // signaled with frame number + 1 by every graphics submission so that any frame can be checked without a fence per
+  // frame, null without VK_KHR_timeline_semaphore in which case the frame fences are used
+  VkSemaphore timeline_ = nullptr;
+  // last known value of the timeline or the frames known from fence waits
+  std::uint64_t completed_frames_ = 0;
+  std::vector<std::uint64_t> submit_signal_values_;
+
+  // objects released while frames in flight may still use them, destroyed in release order once the frames they were
+  // released to have completed so that nothing has to wait for the device to be idle
+  enum class ObjectType : std::uint8_t {
+    buffer,
+    memory,
+    image,
+    image_view,
+    framebuffer,
+    semaphore,
+    swap_chain,
+    descriptor_set,
+  };
+  struct DeferredDestroy {
+    ObjectType type;
+    std::uint64_t handle;
+    // number of frames that have to complete first
+    std::uint64_t frames;
+  };
+  // released by the UI thread on resize and by the render thread for textures
+  std::mutex deletion_mutex_;
+  std::deque<DeferredDestroy> deletion_queue_;
+
+  // requested from the UI thread, read by whichever thread renders
+  std::atomic<bool> capture_all_ = false;
+  std::atomic<bool> capture_next_ = false;
+  // the swap chain images can be copied from, always true for offscreen images
+  bool capture_supported_ = false;
+  std::function<void(FrameCapture const&)> capture_handler_;
+
+  // GPU timestamps, 2 queries per frame in flight
+  VkQueryPool timestamp_pool_ = nullptr;
+  std::uint32_t timestamp_query_count_ = 0;
+  std::vector<std::uint8_t> timestamps_written_;
+  // steady clock nanoseconds minus device timestamp nanoseconds, see `read_gpu_time`
+  std::int64_t gpu_clock_offset_ = std::numeric_limits<std::int64_t>::min();
+
+  // offscreen render targets used instead of the swap chain in headless mode
+  struct OffscreenImage {
+    VkImage image = nullptr;
+    VkDeviceMemory memory = nullptr;
+  };
+  std::vector<OffscreenImage> offscreen_images_;
+  std::vector<ImGui_ImplVulkanH_Frame> offscreen_frames_;
+
+  // the main window renders to a transient multisampled image that is resolved into the swap chain or offscreen image
+  // at the end of the subpass, shared by all frames since the render pass dependency orders their writes
+  VkSampleCountFlagBits msaa_samples_ = VK_SAMPLE_COUNT_1_BIT;
+  struct MultisampleTarget {
+    VkImage image = nullptr;
+    VkDeviceMemory memory = nullptr;
+    VkImageView view = nullptr;
+  };
+  MultisampleTarget multisample_;
+
+  // ImGui is rendered into the top left part of this image and blitted up into the swap chain or offscreen image when
+  // the render scale is below 1. Sized for the whole window so that the scale can change without reallocating, created
+  // on first use and shared by all frames like the multisampled image
+  struct ScaledTarget {
+    VkImage image = nullptr;
+    VkDeviceMemory memory = nullptr;
+    VkImageView view = nullptr;
+    VkFramebuffer framebuffer = nullptr;
+  };
+  ScaledTarget scaled_;
+  // compatible with the main render pass, only leaves the image ready to be blitted from instead
+  VkRenderPass scaled_render_pass_ = nullptr;
+  // the main window images can be blitted to
+  bool render_scale_supported_ = false;
+  VkFilter upscale_filter_ = VK_FILTER_LINEAR;
+  RenderScalePolicy render_scale_policy_;
+  // unquantized scale the adaptive mode is heading towards
+  float render_scale_target_ = 1;
+  // scale of the last rendered frame
+  float render_scale_ = 1;
+
+  // swap chain images of the main window, created by us instead of ImGui_ImplVulkanH_CreateOrResizeWindow so that
+  // resizing doesn't have to wait for the device to be idle
+  std::vector<ImGui_ImplVulkanH_Frame> swap_chain_frames_;
+  // render complete semaphores per image, a new set for every swap chain
+  std::vector<ImGui_ImplVulkanH_FrameSemaphores> swap_chain_semaphores_;
+
+  // textures uploaded through the staging ring, the copies are recorded at the start of the next frame
+  struct Texture {
+    VkImage image = nullptr;
+    VkDeviceMemory memory = nullptr;
+    VkImageView view = nullptr;
+  };
+  struct Upload {
+    VkImage image = nullptr;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    VkBuffer buffer = nullptr;
+    VkDeviceSize offset = 0;
+    // staging memory of uploads that didn't fit into the ring
+    VkDeviceMemory dedicated_memory = nullptr;
+    // ring position released once the copy has completed
+    std::uint64_t ring_end = 0;
+    // frame the copy was recorded in
+    std::uint64_t frame = 0;
+  };
+  struct RetiredTexture {
+    Texture texture;
+    VkDescriptorSet descriptor_set = nullptr;
+  };
+  // uploads may be requested on the UI thread while the render thread records
+  std::mutex upload_mutex_;
+  StagingRing staging_;
+  VkSampler texture_sampler_ = nullptr;
+  std::unordered_map<VkDescriptorSet, Texture> textures_;
+  ImTextureID font_texture_ = nullptr;
+  std::vector<Upload> pending_uploads_;
+  std::deque<Upload> recorded_uploads_;
+  std::vector<RetiredTexture> pending_destroys_;
+
+  // ImGui geometry of all frames in flight in one persistently mapped ring, draw lists are copied straight into it
+  StagingRing geometry_;
+  bool geometry_device_local_ = false;
+  // largest geometry of a single frame so far
+  VkDeviceSize geometry_high_water_ = 0;
+  VkShaderModule vertex_shader_ = nullptr;
+  VkShaderModule fragment_shader_ = nullptr;
+  VkPipelineLayout pipeline_layout_ = nullptr;
+  VkPipeline pipeline_ = nullptr;
+  // the swap chain render pass is recreated with the swap chain
+  VkRenderPass pipeline_render_pass_ = nullptr;
+  // creation of the above during startup, nothing else touches them until it is done
+  std::future<void> pipeline_build_;
+
+  ParallelRecording parallel_recording_;
+  std::unique_ptr<RecordingWorkers> workers_;
+  // consecutive draw lists recorded by each worker
+  struct DrawRange {
+    int first_list = 0;
+    int last_list = 0;
+    // vertex and index offsets of the first list within the frame's geometry
+    std::uint32_t vertex = 0;
+    std::uint32_t index = 0;
+  };
+  std::vector<DrawRange> draw_ranges_;
+
+#ifdef IMGUI_HAS_VIEWPORT
+  // OS window of an ImGui viewport outside of the main window, drawn and presented together with the main window
+  struct ViewportWindow {
+    Vulkan* vulkan = nullptr;
+    ImGuiViewport* viewport = nullptr;
+    ImGui_ImplVulkanH_Window window;
+    // signalled by the image acquire of each frame in flight
+    std::vector<VkSemaphore> image_acquired;
+    VkPipeline pipeline = nullptr;
+    VkRenderPass pipeline_render_pass = nullptr;
+    // whether the frame being recorded draws to the window
+    bool acquired = false;
+    bool rebuild = false;
+  };
+  std::vector<std::unique_ptr<ViewportWindow>> viewports_;
+  // ImGui's renderer callbacks have no user data, set while ImGui may create viewport windows
+  inline static thread_local Vulkan* updating_viewports_ = nullptr;
+  // the backend still owns the renderer data of the main viewport
+  inline static void (*backend_destroy_window_)(ImGuiViewport*) = nullptr;
+#endif
+  // location of the frame's geometry in the ring
+  struct FrameGeometry {
+    // compatible with the render pass the geometry is drawn in
+    VkPipeline pipeline = nullptr;
+    VkDeviceSize vertex_offset = 0;
+    VkDeviceSize index_offset = 0;
+    int fb_width = 0;
+    int fb_height = 0;
+  };
+
+  [[nodiscard]] auto find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags properties) const -> std::uint32_t;
+  [[nodiscard]] auto try_find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags properties) const
+      -> std::optional<std::uint32_t>;
+  [[nodiscard]] auto create_render_pass(VkFormat format, VkImageLayout final_layout) const -> VkRenderPass;
+  // null target without multisampling
+  [[nodiscard]] auto create_multisample_target(VkFormat format, VkExtent2D extent) const -> MultisampleTarget;
+  void destroy_multisample_target(MultisampleTarget& target) const noexcept;
+  // the multisampled image comes first if there is one
+  [[nodiscard]] auto create_framebuffer(VkImageView view, VkExtent2D extent) const -> VkFramebuffer;
+  void destroy_offscreen();
+  // blits need format support on top of the transfer destination usage
+  void check_render_scale_support(VkFormat format, VkImageUsageFlags supported_usage);
+  void create_scaled_target(VkExtent2D extent);
+  void destroy_scaled_target() noexcept;
+  // scale of the next frame from the policy and the GPU time of the last completed frame of its slot
+  [[nodiscard]] auto next_render_scale(FrameContext const& frame, float gpu_milliseconds) noexcept -> float;
+  void record_upscale(VkCommandBuffer command_buffer, VkImage image, VkExtent2D source, VkExtent2D extent,
+                      VkImageLayout layout);
+  void destroy_frame_contexts();
+  void select_present_mode(ImGui_ImplVulkanH_Window* wd);
+  void select_surface_format(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface);
+  // false if the surface currently has no area, e.g. while minimized
+  [[nodiscard]] auto create_swap_chain(int width, int height) -> bool;
+  void destroy_swap_chain_images(std::vector<ImGui_ImplVulkanH_Frame>& frames,
+                                 std::vector<ImGui_ImplVulkanH_FrameSemaphores>& semaphores);
+  void create_timestamp_queries(std::uint32_t frame_count);
+  void read_gpu_time(std::uint32_t frame, FrameTimings& timings);
+  [[nodiscard]] auto lock_queue() -> std::unique_lock<std::mutex>;
+  [[nodiscard]] auto lock_descriptor_pool() -> std::unique_lock<std::mutex>;
+  void create_host_buffer(VkDeviceSize size, VkBufferUsageFlags usage, bool device_local, VkBuffer& buffer,
+                          VkDeviceMemory& memory, void** mapped);
+  void reserve_geometry(VkDeviceSize size);
+  void destroy_geometry();
+  // rethrows errors of `build_pipeline`
+  void wait_for_pipeline();
+  // (re)creates the pipeline if it was created for a different render pass
+  void update_pipeline(VkRenderPass render_pass, VkSampleCountFlagBits samples, VkPipeline& pipeline,
+                       VkRenderPass& pipeline_render_pass);
+  void setup_render_state(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameGeometry const& geometry);
+  [[nodiscard]] auto allocate_geometry(ImDrawData const* draw_data, FrameContext& frame, VkPipeline pipeline)
+      -> FrameGeometry;
+  void copy_geometry(ImDrawData const* draw_data, FrameGeometry const& geometry, DrawRange const& range);
+  void record_draw_lists(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameGeometry const& geometry,
+                         DrawRange const& range);
+  void render_draw_data(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameContext& frame,
+                        VkPipeline pipeline);
+  [[nodiscard]] auto use_parallel_recording(ImDrawData const* draw_data) const noexcept -> bool;
+  [[nodiscard]] auto split_draw_lists(ImDrawData const* draw_data, std::uint32_t max_ranges) -> std::uint32_t;
+  void create_secondary_command_buffers(FrameContext& frame, std::uint32_t count);
+  void record_parallel(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameContext& frame,
+                       VkRenderPass render_pass, VkFramebuffer framebuffer);
+  [[nodiscard]] auto record_uploads(FrameContext& frame) -> bool;
+  void retire_uploads(std::uint64_t completed_frame);
+  // null handles are skipped
+  template <typename Handle>
+  void defer_destroy(ObjectType type, Handle handle, std::uint64_t frames);
+  void destroy_deferred(std::uint64_t completed_frames);
+  void destroy_object(DeferredDestroy const& object);
+  void record_capture(FrameContext& frame, VkImage image, VkImageLayout layout);
+  void create_readback(Readback& readback, VkDeviceSize size);
+  void destroy_readback(Readback& readback);
+  void destroy_texture_objects(Texture const& texture, VkDescriptorSet descriptor_set);
+  void destroy_textures();
+#ifdef IMGUI_HAS_VIEWPORT
+  static void create_viewport(ImGuiViewport* viewport);
+  static void destroy_viewport(ImGuiViewport* viewport);
+  static void resize_viewport(ImGuiViewport* viewport, ImVec2 size);
+  void resize_viewport_window(ViewportWindow& viewport, int width, int height);
+  void destroy_viewport_window(ViewportWindow& viewport);
+  void record_viewports(std::uint32_t slot, FrameContext& frame);
+#endif
+};
+
+[[nodiscard]] inline auto Vulkan::main_window_data() const noexcept -> ImGui_ImplVulkanH_Window const& {
+  return main_window_data_;
+}
+[[nodiscard]] inline auto Vulkan::main_window_data() noexcept -> ImGui_ImplVulkanH_Window& { return main_window_data_; }
+[[nodiscard]] inline auto Vulkan::device_info() const noexcept -> DeviceInfo const& { return shared_device_->info_; }
+
+auto Vulkan::descriptor_stats() -> DescriptorStats {
+  auto lock = lock_descriptor_pool();
+  return shared_device_->descriptors_.stats();
+}
+
+static auto vk_result_string(VkResult err) noexcept -> char const* {
+  switch (err) {
+#define VK_ERR_STR(e) \
+  case VK_##e: return "VK_" #e
+    VK_ERR_STR(SUCCESS);
+    VK_ERR_STR(ERROR_OUT_OF_HOST_MEMORY);
+    VK_ERR_STR(ERROR_DEVICE_LOST);
+    VK_ERR_STR(ERROR_EXTENSION_NOT_PRESENT);
+    VK_ERR_STR(ERROR_TOO_MANY_OBJECTS);
+    VK_ERR_STR(ERROR_UNKNOWN);
+    VK_ERR_STR(ERROR_FRAGMENTATION);
+    VK_ERR_STR(ERROR_SURFACE_LOST_KHR);
+    VK_ERR_STR(SUBOPTIMAL_KHR);
+    VK_ERR_STR(ERROR_INCOMPATIBLE_DISPLAY_KHR);
+    VK_ERR_STR(ERROR_INVALID_SHADER_NV);
+    VK_ERR_STR(ERROR_NOT_PERMITTED_EXT);
+    VK_ERR_STR(THREAD_IDLE_KHR);
+    VK_ERR_STR(OPERATION_NOT_DEFERRED_KHR);
+    VK_ERR_STR(ERROR_OUT_OF_POOL_MEMORY_KHR);
+    VK_ERR_STR(ERROR_INVALID_EXTERNAL_HANDLE_KHR);
+    VK_ERR_STR(ERROR_INVALID_DEVICE_ADDRESS_EXT);
+    VK_ERR_STR(ERROR_PIPELINE_COMPILE_REQUIRED_EXT);
+    VK_ERR_STR(RESULT_MAX_ENUM);
+#undef VK_ERR_STR
+    default: return "VK_UNKNOWN_ERROR";
+  }
+}
+
+[[noreturn]] IMGUI_VK_NOINLINE static void throw_vk_result(VkResult err) {
+  vthrow_gui_error(vk_result_string(err), err);
+}
+
+// successful calls only cost a branch, positive status codes are just reported in validation builds
+static inline void check_vk_result(VkResult err) {
+  if (err == VK_SUCCESS) [[likely]] return;
+  if (err < 0) [[unlikely]] throw_vk_result(err);
+  if constexpr (build_config.validation) std::fprintf(stderr, "[vulkan] Error: VkResult = %s\n", vk_result_string(err));
+}
+
+void DescriptorAllocator::create(VkDevice device, VkAllocationCallbacks const* allocator) {
+  device_ = device;
+  allocator_ = allocator;
+  VkDescriptorSetLayoutBinding binding{
+      .binding = 0,
+      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+      .descriptorCount = 1,
+      .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+  };
+  VkDescriptorSetLayoutCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .bindingCount = 1,
+      .pBindings = &binding,
+  };
+  auto err = vkCreateDescriptorSetLayout(device_, &info, allocator_, &layout_);
+  check_vk_result(err);
+}
+
+void DescriptorAllocator::destroy() noexcept {
+  for (auto* pool : pools_) vkDestroyDescriptorPool(device_, pool, allocator_);
+  pools_.clear();
+  free_sets_.clear();
+  vkDestroyDescriptorSetLayout(device_, layout_, allocator_);
+  layout_ = nullptr;
+  stats_ = {};
+}
+
+void DescriptorAllocator::add_pool() {
+  last_pool_sets_ = pools_.empty() ? initial_pool_sets : std::min(2 * last_pool_sets_, max_pool_sets);
+  VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, last_pool_sets_};
+  // sets are recycled by the allocator so they never have to be freed individually
+  VkDescriptorPoolCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .maxSets = last_pool_sets_,
+      .poolSizeCount = 1,
+      .pPoolSizes = &pool_size,
+  };
+  VkDescriptorPool pool;
+  auto err = vkCreateDescriptorPool(device_, &info, allocator_, &pool);
+  check_vk_result(err);
+  pools_.push_back(pool);
+  stats_.pools = static_cast<std::uint32_t>(pools_.size());
+  stats_.capacity += last_pool_sets_;
+}
+
+auto DescriptorAllocator::allocate() -> VkDescriptorSet {
+  VkDescriptorSet set = nullptr;
+  if (!free_sets_.empty()) {
+    set = free_sets_.back();
+    free_sets_.pop_back();
+  } else {
+    if (pools_.empty()) add_pool();
+    VkDescriptorSetAllocateInfo info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = pools_.back(),
+        .descriptorSetCount = 1,
+        .pSetLayouts = &layout_,
+    };
+    auto err = vkAllocateDescriptorSets(device_, &info, &set);
+    if (err == VK_ERROR_OUT_OF_POOL_MEMORY || err == VK_ERROR_FRAGMENTED_POOL) {
+      add_pool();
+      info.descriptorPool = pools_.back();
+      err = vkAllocateDescriptorSets(device_, &info, &set);
+    }
+    check_vk_result(err);
+  }
+  ++stats_.live;
+  stats_.peak = std::max(stats_.peak, stats_.live);
+  stats_.recycled = static_cast<std::uint32_t>(free_sets_.size());
+  return set;
+}
+
+void DescriptorAllocator::free(VkDescriptorSet set) {
+  free_sets_.push_back(set);
+  --stats_.live;
+  stats_.recycled = static_cast<std::uint32_t>(free_sets_.size());
+}
+
+auto DescriptorAllocator::stats() const noexcept -> DescriptorStats { return stats_; }
+
+Device::Device(std::span<char const* const> extensions, SDL_Window* window, VkAllocationCallbacks const* allocator,
+               std::shared_ptr<HostAllocator> host_allocator, GpuSelection const& selection)
+    : allocator_(allocator), host_allocator_(std::move(host_allocator)), headless_(window == nullptr) {
+  VkResult err;
+
+  // Create Vulkan Instance
+  {
+    // vkEnumerateInstanceVersion only exists on 1.1 loaders, 1.1 is needed to query device UUIDs
+    auto vkEnumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+        vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+    if (vkEnumerateInstanceVersion != nullptr && vkEnumerateInstanceVersion(&api_version_) == VK_SUCCESS) {
+      api_version_ = std::min<std::uint32_t>(api_version_, VK_API_VERSION_1_1);
+    } else {
+      api_version_ = VK_API_VERSION_1_0;
+    }
+    VkApplicationInfo app_info{
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pEngineName = "imgui_vulkan",
+        .apiVersion = api_version_,
+    };
+    VkInstanceCreateInfo create_info{
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pApplicationInfo = &app_info,
+        .enabledExtensionCount = static_cast<std::uint32_t>(extensions.size()),
+        .ppEnabledExtensionNames = extensions.data(),
+    };
+    if constexpr (build_config.validation) {
+      // Enabling validation layers
+      constexpr static std::array<const char*, 1> layers{"VK_LAYER_KHRONOS_validation"};
+      create_info.enabledLayerCount = static_cast<std::uint32_t>(layers.size());
+      create_info.ppEnabledLayerNames = layers.data();
+
+      // Enable debug report extension (we need additional storage, so we duplicate the user array to add our new
+      // extension to it)
+      std::vector<char const*> extensions_ext(extensions.size() + 1);
+      std::ranges::copy(extensions, extensions_ext.begin());
+      extensions_ext.back() = "VK_EXT_debug_report";
+      create_info.enabledExtensionCount = static_cast<std::uint32_t>(extensions_ext.size());
+      create_info.ppEnabledExtensionNames = extensions_ext.data();
+
+      // Create Vulkan Instance
+      err = vkCreateInstance(&create_info, allocator_, &instance_);
+      check_vk_result(err);
+
+      // Get the function pointer (required for any extensions)
+      auto vkCreateDebugReportCallbackEXT = reinterpret_cast<PFN_vkCreateDebugReportCallbackEXT>(
+          vkGetInstanceProcAddr(instance_, "vkCreateDebugReportCallbackEXT"));
+      if (vkCreateDebugReportCallbackEXT == nullptr) [[unlikely]]
+        vthrow_gui_error("Could not get vkCreateDebugReportCallbackEXT");
+
+      // Setup the debug report callback
+      VkDebugReportCallbackCreateInfoEXT debug_report_ci{
+          .sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT,
+          .flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT |
+                   VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
+          .pfnCallback = debug_report,
+          .pUserData = nullptr,
+      };
+      err = vkCreateDebugReportCallbackEXT(instance_, &debug_report_ci, allocator_, &debug_report_);
+      check_vk_result(err);
+    } else {
+      // Create Vulkan Instance without any debug feature
+      err = vkCreateInstance(&create_info, allocator_, &instance_);
+      check_vk_result(err);
+    }
+  }
+
+  // Select GPU, presentation support can only be checked against an actual surface
+  {
+    VkSurfaceKHR surface = nullptr;
+    if (window != nullptr && SDL_Vulkan_CreateSurface(window, instance_, &surface) == 0) [[unlikely]] {
+      throw_gui_error("Failed to create Vulkan surface: {}.", SDL_GetError());
+    }
+    // SDL creates surfaces without allocation callbacks
+    scope_guard surface_guard([this, surface]() {
+      if (surface != nullptr) vkDestroySurfaceKHR(instance_, surface, nullptr);
+    });
+    select_physical_device(surface, selection);
+  }
+
+  // Select queue families
+  {
+    uint32_t count;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> queues(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &count, queues.data());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device_, &properties);
+    timestamp_valid_bits_ = queues[queue_family_].timestampValidBits;
+    timestamp_period_ = properties.limits.timestampPeriod;
+
+    // transfer only families are backed by DMA engines on discrete GPUs, uploads fall back to the graphics queue
+    auto transfer_it = std::ranges::find_if(queues, [](auto const& queue) {
+      return (queue.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 &&
+             (queue.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0 && queue.queueCount > 0;
+    });
+    if (transfer_it != queues.end()) transfer_queue_family_ = static_cast<std::uint32_t>(transfer_it - queues.begin());
+    info_.transfer_queue = transfer_it != queues.end();
+  }
+
+  // Create Logical Device (with a graphics and an optional transfer queue)
+  {
+    // headless rendering doesn't need any presentation support
+    std::vector<const char*> device_extensions;
+    if (!headless_) device_extensions.push_back("VK_KHR_swapchain");
+    if (incremental_present_) device_extensions.push_back("VK_KHR_incremental_present");
+    if (present_wait_) {
+      device_extensions.push_back("VK_KHR_present_id");
+      device_extensions.push_back("VK_KHR_present_wait");
+    }
+    if (timeline_semaphore_) device_extensions.push_back("VK_KHR_timeline_semaphore");
+    // only the features of enabled extensions are chained
+    void* features = nullptr;
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+        .timelineSemaphore = VK_TRUE,
+    };
+    if (timeline_semaphore_) features = &timeline_features;
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+        .pNext = features,
+        .presentWait = VK_TRUE,
+    };
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+        .pNext = &present_wait_features,
+        .presentId = VK_TRUE,
+    };
+    if (present_wait_) features = &present_id_features;
+    std::array<float, 1> queue_priority{1.0f};
+    auto const has_transfer_queue = transfer_queue_family_ != std::numeric_limits<std::uint32_t>::max();
+    std::array<VkDeviceQueueCreateInfo, 2> queue_info{{
+        {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = queue_family_,
+            .queueCount = static_cast<std::uint32_t>(queue_priority.size()),
+            .pQueuePriorities = queue_priority.data(),
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+            .queueFamilyIndex = transfer_queue_family_,
+            .queueCount = static_cast<std::uint32_t>(queue_priority.size()),
+            .pQueuePriorities = queue_priority.data(),
+        },
+    }};
+    VkDeviceCreateInfo create_info{
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = features,
+        .queueCreateInfoCount = has_transfer_queue ? 2u : 1u,
+        .pQueueCreateInfos = queue_info.data(),
+        .enabledExtensionCount = static_cast<std::uint32_t>(device_extensions.size()),
+        .ppEnabledExtensionNames = device_extensions.data(),
+    };
+    err = vkCreateDevice(physical_device_, &create_info, allocator_, &device_);
+    check_vk_result(err);
+    vkGetDeviceQueue(device_, queue_family_, 0, &queue_);
+    if (has_transfer_queue) vkGetDeviceQueue(device_, transfer_queue_family_, 0, &transfer_queue_);
+    dispatch_.load(device_);
+    if (present_wait_) {
+      wait_for_present_ =
+          reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device_, "vkWaitForPresentKHR"));
+      present_wait_ = wait_for_present_ != nullptr;
+    }
+    if (timeline_semaphore_) timeline_semaphore_ = dispatch_.load_timeline_semaphore(device_);
+  }
+
+  descriptors_.create(device_, allocator_);
+}
+
+static auto to_gpu_type(VkPhysicalDeviceType type) noexcept -> GpuType {
+  switch (type) {
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return GpuType::integrated;
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return GpuType::discrete;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return GpuType::virtual_gpu;
+    case VK_PHYSICAL_DEVICE_TYPE_CPU: return GpuType::cpu;
+    default: return GpuType::other;
+  }
+}
+
+// higher is better, software rasterizers always come last
+static auto gpu_rank(GpuType type, GpuPreference preference) noexcept -> int {
+  switch (type) {
+    case GpuType::discrete: return preference == GpuPreference::high_performance ? 4 : 3;
+    case GpuType::integrated: return preference == GpuPreference::high_performance ? 3 : 4;
+    case GpuType::virtual_gpu: return 2;
+    case GpuType::other: return 1;
+    case GpuType::cpu: return 0;
+  }
+  return 0;
+}
+
+// index, UUID in hex with optional dashes or case insensitive part of the name
+static auto matches_gpu(DeviceInfo const& info, std::string_view device) noexcept -> bool {
+  auto lower = [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); };
+  if (std::ranges::all_of(device, [](char c) { return c >= '0' && c <= '9'; })) {
+    return std::to_string(info.index) == device;
+  }
+
+  std::string hex;
+  for (char c : device) {
+    if (c != '-') hex.push_back(lower(c));
+  }
+  if (hex.size() == 2 * info.uuid.size() && std::ranges::all_of(hex, [](char c) { return std::isxdigit(c) != 0; })) {
+    std::string uuid;
+    for (auto byte : info.uuid) uuid += fmt::format("{:02x}", byte);
+    return uuid == hex;
+  }
+
+  auto name = std::string_view(info.name);
+  auto found = std::ranges::search(name, device, [&](char l, char r) { return lower(l) == lower(r); });
+  return !found.empty();
+}
+
+void Device::select_physical_device(VkSurfaceKHR surface, GpuSelection const& selection) {
+  uint32_t gpu_count;
+  VkResult err = vkEnumeratePhysicalDevices(instance_, &gpu_count, nullptr);
+  check_vk_result(err);
+  if (gpu_count == 0) [[unlikely]] { vthrow_gui_error("Could not find any GPUs!"); }
+
+  std::vector<VkPhysicalDevice> gpus(gpu_count);
+  err = vkEnumeratePhysicalDevices(instance_, &gpu_count, gpus.data());
+  check_vk_result(err);
+
+  // 1.1 entry points are not exported by 1.0 loaders, they are loaded only when the instance was created with 1.1
+  PFN_vkGetPhysicalDeviceFeatures2 get_features2 = nullptr;
+  PFN_vkGetPhysicalDeviceProperties2 get_properties2 = nullptr;
+  if (api_version_ >= VK_API_VERSION_1_1) {
+    get_features2 = reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(
+        vkGetInstanceProcAddr(instance_, "vkGetPhysicalDeviceFeatures2"));
+    get_properties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2>(
+        vkGetInstanceProcAddr(instance_, "vkGetPhysicalDeviceProperties2"));
+  }
+
+  struct Candidate {
+    VkPhysicalDevice gpu;
+    std::uint32_t queue_family;
+    bool incremental_present;
+    bool present_wait;
+    bool timeline_semaphore;
+    DeviceInfo info;
+  };
+  std::vector<Candidate> candidates;
+  for (std::uint32_t index = 0; index < gpu_count; ++index) {
+    auto* gpu = gpus[index];
+
+    // needs a queue family that can both render and present so a single queue does everything
+    uint32_t count;
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> queues(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, queues.data());
+    auto queue_family = std::numeric_limits<std::uint32_t>::max();
+    for (std::uint32_t i = 0; i < count; ++i) {
+      if ((queues[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) continue;
+      VkBool32 supported = VK_TRUE;
+      if (surface != nullptr) {
+        err = vkGetPhysicalDeviceSurfaceSupportKHR(gpu, i, surface, &supported);
+        check_vk_result(err);
+      }
+      if (supported == VK_TRUE) {
+        queue_family = i;
+        break;
+      }
+    }
+    if (queue_family == std::numeric_limits<std::uint32_t>::max()) continue;
+
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> device_extensions(count);
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, device_extensions.data());
+    auto has_extension = [&](std::string_view name) {
+      return std::ranges::any_of(device_extensions, [&](auto const& extension) {
+        return std::string_view(extension.extensionName) == name;
+      });
+    };
+    bool incremental_present = false;
+    bool present_wait = false;
+    if (!headless_) {
+      if (!has_extension("VK_KHR_swapchain")) continue;
+      incremental_present = has_extension("VK_KHR_incremental_present");
+      present_wait = has_extension("VK_KHR_present_id") && has_extension("VK_KHR_present_wait");
+    }
+    bool timeline_semaphore = has_extension("VK_KHR_timeline_semaphore");
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(gpu, &properties);
+    // the extensions may be listed without the driver implementing the features
+    if ((present_wait || timeline_semaphore) && get_features2 != nullptr &&
+        properties.apiVersion >= VK_API_VERSION_1_1) {
+      VkPhysicalDeviceTimelineSemaphoreFeatures timeline_features{
+          .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+      };
+      VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{
+          .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,
+          .pNext = timeline_semaphore ? &timeline_features : nullptr,
+      };
+      VkPhysicalDevicePresentIdFeaturesKHR present_id_features{
+          .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,
+          .pNext = &present_wait_features,
+      };
+      VkPhysicalDeviceFeatures2 features{
+          .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+          .pNext = present_wait ? static_cast<void*>(&present_id_features) : present_wait_features.pNext,
+      };
+      get_features2(gpu, &features);
+      present_wait =
+          present_wait && present_id_features.presentId == VK_TRUE && present_wait_features.presentWait == VK_TRUE;
+      timeline_semaphore = timeline_semaphore && timeline_features.timelineSemaphore == VK_TRUE;
+    } else {
+      present_wait = false;
+      timeline_semaphore = false;
+    }
+    DeviceInfo info{
+        .name = properties.deviceName,
+        .index = index,
+        .vendor_id = properties.vendorID,
+        .device_id = properties.deviceID,
+        .driver_version = properties.driverVersion,
+        .type = to_gpu_type(properties.deviceType),
+    };
+    if (get_properties2 != nullptr && properties.apiVersion >= VK_API_VERSION_1_1) {
+      VkPhysicalDeviceIDProperties id_properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+      VkPhysicalDeviceProperties2 properties2{
+          .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+          .pNext = &id_properties,
+      };
+      get_properties2(gpu, &properties2);
+      std::ranges::copy(id_properties.deviceUUID, info.uuid.begin());
+    }
+
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(gpu, &memory_properties);
+    for (std::uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+      auto const& heap = memory_properties.memoryHeaps[i];
+      if ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) info.device_local_bytes += heap.size;
+    }
+
+    candidates.push_back({
+        .gpu = gpu,
+        .queue_family = queue_family,
+        .incremental_present = incremental_present,
+        .present_wait = present_wait,
+        .timeline_semaphore = timeline_semaphore,
+        .info = std::move(info),
+    });
+  }
+  if (candidates.empty()) [[unlikely]] {
+    vthrow_gui_error("Could not find a GPU that supports rendering to the window");
+  }
+
+  // the environment lets users pick a GPU without rebuilding the application
+  std::string_view device = selection.device;
+  if (char const* env = SDL_getenv("IMGUI_VK_GPU"); env != nullptr && *env != '\0') device = env;
+
+  auto chosen = candidates.end();
+  if (!device.empty()) {
+    chosen =
+        std::ranges::find_if(candidates, [&](auto const& candidate) { return matches_gpu(candidate.info, device); });
+    if (chosen == candidates.end()) {
+      std::fprintf(stderr, "[vulkan] No usable GPU matches '%.*s', selecting by preference\n",
+                   static_cast<int>(device.size()), device.data());
+    }
+  }
+  if (chosen == candidates.end()) {
+    chosen = std::ranges::max_element(candidates, {}, [&](auto const& candidate) {
+      return std::pair(gpu_rank(candidate.info.type, selection.preference), candidate.info.device_local_bytes);
+    });
+  }
+
+  physical_device_ = chosen->gpu;
+  queue_family_ = chosen->queue_family;
+  incremental_present_ = chosen->incremental_present;
+  present_wait_ = chosen->present_wait;
+  timeline_semaphore_ = chosen->timeline_semaphore;
+  info_ = std::move(chosen->info);
+}
+
+Device::~Device() noexcept {
+  save_pipeline_cache();
+  vkDestroyPipelineCache(device_, pipeline_cache_, allocator_);
+  descriptors_.destroy();
+
+  if constexpr (build_config.validation) {
+    // Remove the debug report callback
+    auto vkDestroyDebugReportCallbackEXT = reinterpret_cast<PFN_vkDestroyDebugReportCallbackEXT>(
+        vkGetInstanceProcAddr(instance_, "vkDestroyDebugReportCallbackEXT"));
+    vkDestroyDebugReportCallbackEXT(instance_, debug_report_, allocator_);
+  }
+
+  vkDestroyDevice(device_, allocator_);
+  vkDestroyInstance(instance_, allocator_);
+}
+
+Vulkan::Vulkan(std::shared_ptr<Device> device)
+    : shared_device_(std::move(device)),
+      allocator_(shared_device_->allocator_),
+      instance_(shared_device_->instance_),
+      physical_device_(shared_device_->physical_device_),
+      device_(shared_device_->device_),
+      queue_family_(shared_device_->queue_family_),
+      queue_(shared_device_->queue_),
+      transfer_queue_family_(shared_device_->transfer_queue_family_),
+      transfer_queue_(shared_device_->transfer_queue_),
+      pipeline_cache_(shared_device_->pipeline_cache_),
+      vk_(&shared_device_->dispatch_),
+      headless_(shared_device_->headless_),
+      incremental_present_(shared_device_->incremental_present_),
+      wait_for_present_(shared_device_->present_wait_ ? shared_device_->wait_for_present_ : nullptr) {}
+
+auto Vulkan::lock_queue() -> std::unique_lock<std::mutex> { return std::unique_lock(shared_device_->queue_mutex_); }
+
+auto Vulkan::lock_descriptor_pool() -> std::unique_lock<std::mutex> {
+  return std::unique_lock(shared_device_->descriptor_pool_mutex_);
+}
+
+void Vulkan::setup_window(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface, int width, int height) {
+  select_surface_format(wd, surface);
+  auto lock = lock_queue();
+  ImGui_ImplVulkanH_CreateOrResizeWindow(instance_, physical_device_, device_, wd, queue_family_, allocator_, width,
+                                         height, min_image_count_);
+}
+
+void Vulkan::select_surface_format(ImGui_ImplVulkanH_Window* wd, VkSurfaceKHR surface) {
+  wd->Surface = surface;
+
+  // Check for WSI support
+  VkBool32 res;
+  vkGetPhysicalDeviceSurfaceSupportKHR(physical_device_, queue_family_, wd->Surface, &res);
+  if (res != VK_TRUE) [[unlikely]] { vthrow_gui_error("Error no WSI support on physical device 0"); }
+
+  // Select Surface Format
+  constexpr static auto requestSurfaceImageFormat = std::to_array<VkFormat>({
+      VK_FORMAT_B8G8R8A8_UNORM,
+      VK_FORMAT_R8G8B8A8_UNORM,
+      VK_FORMAT_B8G8R8_UNORM,
+      VK_FORMAT_R8G8B8_UNORM,
+  });
+  constexpr static VkColorSpaceKHR requestSurfaceColorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
+  wd->SurfaceFormat = ImGui_ImplVulkanH_SelectSurfaceFormat(
+      physical_device_, wd->Surface, requestSurfaceImageFormat.data(),
+      static_cast<int>(requestSurfaceImageFormat.size()), requestSurfaceColorSpace);
+
+  // Select Present Mode
+  select_present_mode(wd);
+
+  // Create SwapChain, RenderPass, Framebuffer, etc.
+  if (min_image_count_ < 2) [[unlikely]] {
+    throw_gui_error("Need at least 2 frame buffers for swapping, current: {}", min_image_count_);
+  }
+}
+
+auto Vulkan::create_swap_chain(int width, int height) -> bool {
+  auto* wd = &main_window_data_;
+  VkSurfaceCapabilitiesKHR capabilities;
+  auto err = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device_, wd->Surface, &capabilities);
+  check_vk_result(err);
+  // the surface size decides unless it lets the swap chain pick
+  VkExtent2D extent = capabilities.currentExtent;
+  if (extent.width == std::numeric_limits<std::uint32_t>::max()) {
+    extent = {static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height)};
+  }
+  if (extent.width == 0 || extent.height == 0) return false;
+
+  auto image_count = std::max(min_image_count_, capabilities.minImageCount);
+  if (capabilities.maxImageCount != 0) image_count = std::min(image_count, capabilities.maxImageCount);
+  // frame capture copies straight from the presented images
+  capture_supported_ = (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+  // and the render scale blits straight into them
+  check_render_scale_support(wd->SurfaceFormat.format, capabilities.supportedUsageFlags);
+  VkSwapchainCreateInfoKHR info{
+      .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+      .surface = wd->Surface,
+      .minImageCount = image_count,
+      .imageFormat = wd->SurfaceFormat.format,
+      .imageColorSpace = wd->SurfaceFormat.colorSpace,
+      .imageExtent = extent,
+      .imageArrayLayers = 1,
+      .imageUsage = VkImageUsageFlags{VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT} |
+                    (capture_supported_ ? VkImageUsageFlags{VK_IMAGE_USAGE_TRANSFER_SRC_BIT} : VkImageUsageFlags{0}) |
+                    (render_scale_supported_ ? VkImageUsageFlags{VK_IMAGE_USAGE_TRANSFER_DST_BIT}
+                                             : VkImageUsageFlags{0}),
+      .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .preTransform = (capabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) != 0
+                          ? VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR
+                          : capabilities.currentTransform,
+      .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+      .presentMode = wd->PresentMode,
+      .clipped = VK_TRUE,
+      // lets the presentation engine hand over resources and keep showing the old images until the new ones
+      .oldSwapchain = wd->Swapchain,
+  };
+  VkSwapchainKHR swap_chain;
+  err = vkCreateSwapchainKHR(device_, &info, allocator_, &swap_chain);
+  check_vk_result(err);
+
+  // frames in flight may still render to the old images, they are destroyed once those have completed
+  for (auto const& fd : swap_chain_frames_) {
+    defer_destroy(ObjectType::framebuffer, fd.Framebuffer, frame_counter_);
+    defer_destroy(ObjectType::image_view, fd.BackbufferView, frame_counter_);
+  }
+  defer_destroy(ObjectType::image_view, multisample_.view, frame_counter_);
+  defer_destroy(ObjectType::image, multisample_.image, frame_counter_);
+  defer_destroy(ObjectType::memory, multisample_.memory, frame_counter_);
+  defer_destroy(ObjectType::framebuffer, scaled_.framebuffer, frame_counter_);
+  defer_destroy(ObjectType::image_view, scaled_.view, frame_counter_);
+  defer_destroy(ObjectType::image, scaled_.image, frame_counter_);
+  defer_destroy(ObjectType::memory, scaled_.memory, frame_counter_);
+  scaled_ = {};
+  defer_destroy(ObjectType::swap_chain, wd->Swapchain, frame_counter_);
+  wd->Swapchain = swap_chain;
+  wd->Width = static_cast<int>(extent.width);
+  wd->Height = static_cast<int>(extent.height);
+  multisample_ = create_multisample_target(wd->SurfaceFormat.format, extent);
+  // present ids belong to the swap chain they were presented to
+  for (auto& frame : frames_) frame.present_id = 0;
+
+  err = vkGetSwapchainImagesKHR(device_, swap_chain, &image_count, nullptr);
+  check_vk_result(err);
+  std::vector<VkImage> images(image_count);
+  err = vkGetSwapchainImagesKHR(device_, swap_chain, &image_count, images.data());
+  check_vk_result(err);
+  wd->ImageCount = image_count;
+
+  // the render pass only depends on the format, which doesn't change, so the pipeline can stay as well
+  swap_chain_frames_.assign(image_count, {});
+  for (std::uint32_t i = 0; i < image_count; ++i) {
+    auto& fd = swap_chain_frames_[i];
+    fd.Backbuffer = images[i];
+    VkImageViewCreateInfo view_info{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = fd.Backbuffer,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = wd->SurfaceFormat.format,
+        .components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A},
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+    err = vkCreateImageView(device_, &view_info, allocator_, &fd.BackbufferView);
+    check_vk_result(err);
+    fd.Framebuffer = create_framebuffer(fd.BackbufferView, extent);
+  }
+  wd->Frames = swap_chain_frames_.data();
+
+  // a semaphore is only known to be free once its image of the same swap chain is acquired again, pending presents of
+  // the old swap chain may still wait on its set. Released after the old swap chain so they go with it
+  for (auto const& semaphores : swap_chain_semaphores_) {
+    defer_destroy(ObjectType::semaphore, semaphores.RenderCompleteSemaphore, frame_counter_);
+  }
+  swap_chain_semaphores_.assign(image_count, {});
+  for (auto& semaphores : swap_chain_semaphores_) {
+    VkSemaphoreCreateInfo semaphore_info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    err = vkCreateSemaphore(device_, &semaphore_info, allocator_, &semaphores.RenderCompleteSemaphore);
+    check_vk_result(err);
+  }
+  wd->FrameSemaphores = swap_chain_semaphores_.data();
+  wd->FrameIndex = 0;
+  return true;
+}
+
+void Vulkan::destroy_swap_chain_images(std::vector<ImGui_ImplVulkanH_Frame>& frames,
+                                       std::vector<ImGui_ImplVulkanH_FrameSemaphores>& semaphores) {
+  for (auto& fd : frames) {
+    vkDestroyFramebuffer(device_, fd.Framebuffer, allocator_);
+    vkDestroyImageView(device_, fd.BackbufferView, allocator_);
+  }
+  for (auto& semaphore : semaphores) vkDestroySemaphore(device_, semaphore.RenderCompleteSemaphore, allocator_);
+  frames.clear();
+  semaphores.clear();
+}
+
+void Vulkan::create_frame_contexts(std::uint32_t count) {
+  // the swap chain frames created by ImGui come with their own command buffers and fences, those are left unused so
+  // that the CPU is not limited to one frame per swap chain image
+  destroy_frame_contexts();
+  frames_.resize(count);
+  frame_counter_ = 0;
+
+  VkResult err;
+  for (auto& frame : frames_) {
+    {
+      VkCommandPoolCreateInfo info{
+          .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+          .queueFamilyIndex = queue_family_,
+      };
+      err = vkCreateCommandPool(device_, &info, allocator_, &frame.command_pool);
+      check_vk_result(err);
+    }
+    {
+      VkCommandBufferAllocateInfo info{
+          .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+          .commandPool = frame.command_pool,
+          .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+          .commandBufferCount = 1,
+      };
+      err = vkAllocateCommandBuffers(device_, &info, &frame.command_buffer);
+      check_vk_result(err);
+    }
+    {
+      VkFenceCreateInfo info{
+          .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+          .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+      };
+      if (!shared_device_->timeline_semaphore_) {
+        err = vkCreateFence(device_, &info, allocator_, &frame.fence);
+        check_vk_result(err);
+      }
+    }
+    {
+      VkSemaphoreCreateInfo info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+      err = vkCreateSemaphore(device_, &info, allocator_, &frame.image_acquired);
+      check_vk_result(err);
+    }
+    if (transfer_queue_ != nullptr) {
+      VkCommandPoolCreateInfo pool_info{
+          .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+          .queueFamilyIndex = transfer_queue_family_,
+      };
+      err = vkCreateCommandPool(device_, &pool_info, allocator_, &frame.transfer_command_pool);
+      check_vk_result(err);
+      VkCommandBufferAllocateInfo buffer_info{
+          .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+          .commandPool = frame.transfer_command_pool,
+          .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+          .commandBufferCount = 1,
+      };
+      err = vkAllocateCommandBuffers(device_, &buffer_info, &frame.transfer_command_buffer);
+      check_vk_result(err);
+      VkSemaphoreCreateInfo semaphore_info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+      err = vkCreateSemaphore(device_, &semaphore_info, allocator_, &frame.transfer_complete);
+      check_vk_result(err);
+    }
+  }
+  // frame numbers restart so the timeline has to as well, its values can never decrease
+  completed_frames_ = 0;
+  if (shared_device_->timeline_semaphore_) {
+    VkSemaphoreTypeCreateInfo type_info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+    VkSemaphoreCreateInfo info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &type_info};
+    err = vkCreateSemaphore(device_, &info, allocator_, &timeline_);
+    check_vk_result(err);
+  }
+  create_timestamp_queries(count);
+}
+
+void Vulkan::destroy_frame_contexts() {
+  if (frames_.empty()) return;
+  wait_idle();
+  // frame numbers restart with the new frame contexts, the GPU is done with everything released so far
+  destroy_deferred(std::numeric_limits<std::uint64_t>::max());
+  geometry_.release(geometry_.head);
+  for (auto& frame : frames_) {
+    vkDestroySemaphore(device_, frame.image_acquired, allocator_);
+    vkDestroyFence(device_, frame.fence, allocator_);
+    if (frame.command_buffer != nullptr) vkFreeCommandBuffers(device_, frame.command_pool, 1, &frame.command_buffer);
+    vkDestroyCommandPool(device_, frame.command_pool, allocator_);
+    vkDestroySemaphore(device_, frame.transfer_complete, allocator_);
+    if (frame.transfer_command_buffer != nullptr) {
+      vkFreeCommandBuffers(device_, frame.transfer_command_pool, 1, &frame.transfer_command_buffer);
+    }
+    vkDestroyCommandPool(device_, frame.transfer_command_pool, allocator_);
+    // destroying the pools frees their command buffers
+    for (auto* pool : frame.secondary_pools) vkDestroyCommandPool(device_, pool, allocator_);
+    destroy_readback(frame.readback);
+  }
+  frames_.clear();
+  vkDestroySemaphore(device_, timeline_, allocator_);
+  timeline_ = nullptr;
+}
+
+void Vulkan::create_timestamp_queries(std::uint32_t frame_count) {
+  // timestamps are optional, without a query pool none are recorded
+  if (!gpu_timestamps || shared_device_->timestamp_valid_bits_ == 0) return;
+
+  auto const query_count = 2 * frame_count;
+  timestamps_written_.assign(frame_count, 0);
+  if (query_count <= timestamp_query_count_) return;
+
+  // only called while no frames are in flight
+  vkDestroyQueryPool(device_, timestamp_pool_, allocator_);
+  VkQueryPoolCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+      .queryType = VK_QUERY_TYPE_TIMESTAMP,
+      .queryCount = query_count,
+  };
+  auto err = vkCreateQueryPool(device_, &create_info, allocator_, &timestamp_pool_);
+  check_vk_result(err);
+  timestamp_query_count_ = query_count;
+}
+
+void Vulkan::read_gpu_time(std::uint32_t frame, FrameTimings& timings) {
+  if (!gpu_timestamps || timestamp_pool_ == nullptr || timestamps_written_[frame] == 0) return;
+
+  // the frame has been waited on so the results are available
+  std::array<std::uint64_t, 2> timestamps;
+  auto err = vk_->vkGetQueryPoolResults(device_, timestamp_pool_, 2 * frame, 2, sizeof(timestamps), timestamps.data(),
+                                        sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (err != VK_SUCCESS) return;
+
+  auto const valid_bits = shared_device_->timestamp_valid_bits_;
+  auto const mask = valid_bits >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << valid_bits) - 1;
+  auto const ticks = ((timestamps[1] & mask) - (timestamps[0] & mask)) & mask;
+  auto const period = static_cast<double>(shared_device_->timestamp_period_);
+  timings.gpu = static_cast<float>(static_cast<double>(ticks) * period * 1e-6);
+
+  if constexpr (build_config.tracing) {
+    // the device clock has its own epoch. No frame starts before its submission, the offset is the smallest one that
+    // keeps all frames so far after their submissions
+    auto const begin = static_cast<std::int64_t>(static_cast<double>(timestamps[0] & mask) * period);
+    auto const duration = static_cast<std::int64_t>(static_cast<double>(ticks) * period);
+    gpu_clock_offset_ = std::max(gpu_clock_offset_, frames_[frame].submit_time - begin);
+    record_trace_event(TraceTrack::gpu, "GPU frame", begin + gpu_clock_offset_,
+                       begin + gpu_clock_offset_ + duration);
+  }
+}
+
+void Vulkan::set_render_scale_policy(RenderScalePolicy const& policy) noexcept {
+  // the render thread passes the policy with every frame, adapting only starts over when it changes
+  auto const& current = render_scale_policy_;
+  if (policy.scale == current.scale && policy.target_fps == current.target_fps &&
+      policy.min_scale == current.min_scale && policy.max_scale == current.max_scale) {
+    return;
+  }
+  render_scale_policy_ = policy;
+  render_scale_target_ = policy.scale;
+}
+
+auto Vulkan::next_render_scale(FrameContext const& frame, float gpu_milliseconds) noexcept -> float {
+  if (!render_scale_supported_) return 1;
+  auto const& policy = render_scale_policy_;
+  // the bounds only limit adapting, a fixed scale can use the whole range
+  bool const adapting = policy.target_fps > 0;
+  auto const min_scale = adapting ? std::clamp(policy.min_scale, 0.25f, 1.0f) : 0.25f;
+  auto const max_scale = adapting ? std::clamp(policy.max_scale, min_scale, 1.0f) : 1.0f;
+  if (adapting && gpu_milliseconds > 0) {
+    // fill rate goes with the area. Aim a bit below the budget and only move part of the way every frame since the GPU
+    // time lags behind by the frames in flight and would make the scale oscillate otherwise
+    auto const budget = 0.9f * 1000.0f / policy.target_fps;
+    auto const ideal = frame.render_scale * std::sqrt(budget / gpu_milliseconds);
+    render_scale_target_ += 0.1f * (ideal - render_scale_target_);
+  }
+  render_scale_target_ = std::clamp(render_scale_target_, min_scale, max_scale);
+  // steps of 1/32 so that the image isn't resampled differently on every frame
+  return std::clamp(std::round(render_scale_target_ * 32.0f) / 32.0f, min_scale, max_scale);
+}
+
+static auto to_vk_present_mode(PresentMode mode) noexcept -> VkPresentModeKHR {
+  switch (mode) {
+    case PresentMode::fifo: return VK_PRESENT_MODE_FIFO_KHR;
+    case PresentMode::fifo_relaxed: return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    case PresentMode::mailbox: return VK_PRESENT_MODE_MAILBOX_KHR;
+    case PresentMode::immediate: return VK_PRESENT_MODE_IMMEDIATE_KHR;
+  }
+  return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void Vulkan::select_present_mode(ImGui_ImplVulkanH_Window* wd) {
+  // FIFO is always supported
+  auto const present_modes = std::to_array<VkPresentModeKHR>({present_mode_, VK_PRESENT_MODE_FIFO_KHR});
+  wd->PresentMode = ImGui_ImplVulkanH_SelectPresentMode(physical_device_, wd->Surface, present_modes.data(),
+                                                        static_cast<int>(present_modes.size()));
+  // mailbox needs an extra image to not block on present
+  min_image_count_ =
+      std::max(2u, static_cast<std::uint32_t>(ImGui_ImplVulkanH_GetMinImageCountFromPresentMode(wd->PresentMode)));
+}
+
+void Vulkan::set_present_mode(PresentMode mode) noexcept {
+  auto vk_mode = to_vk_present_mode(mode);
+  if (vk_mode == present_mode_) return;
+  present_mode_ = vk_mode;
+  // the new mode is picked up when the swap chain is recreated
+  if (main_window_data_.Swapchain != nullptr) swap_chain_rebuild_ = true;
+#ifdef IMGUI_HAS_VIEWPORT
+  for (auto& viewport : viewports_) viewport->rebuild = true;
+#endif
+}
+
+void Vulkan::init(SDL_Window* window) {
+  // no platform backend in headless mode
+  if (window != nullptr) ImGui_ImplSDL2_InitForVulkan(window);
+  {
+    // the backend allocates and frees the descriptor set of its own font texture
+    VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1};
+    VkDescriptorPoolCreateInfo pool_info{
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = &pool_size,
+    };
+    auto err = vkCreateDescriptorPool(device_, &pool_info, allocator_, &backend_descriptor_pool_);
+    check_vk_result(err);
+  }
+  ImGui_ImplVulkan_InitInfo init_info{
+      .Instance = instance_,
+      .PhysicalDevice = physical_device_,
+      .Device = device_,
+      .QueueFamily = queue_family_,
+      .Queue = queue_,
+      .PipelineCache = pipeline_cache_,
+      .DescriptorPool = backend_descriptor_pool_,
+      .Subpass = 0,
+      .MinImageCount = min_image_count_,
+      // the backend keeps one set of vertex and index buffers per image count, one per frame in flight is needed
+      .ImageCount = std::max(min_image_count_, static_cast<std::uint32_t>(frames_.size())),
+      .MSAASamples = msaa_samples_,
+      .Allocator = allocator_,
+      .CheckVkResultFn = check_vk_result,
+  };
+  // only matters if the backend was built without prototypes, its device functions then skip the loader too
+  ImGui_ImplVulkan_LoadFunctions(
+      [](char const* name, void* user_data) -> PFN_vkVoidFunction {
+        auto const* vulkan = static_cast<Vulkan const*>(user_data);
+        if (auto* function = vkGetDeviceProcAddr(vulkan->device_, name); function != nullptr) return function;
+        return vkGetInstanceProcAddr(vulkan->instance_, name);
+      },
+      this);
+  ImGui_ImplVulkan_Init(&init_info, main_window_data_.RenderPass);
+#ifdef IMGUI_HAS_VIEWPORT
+  if ((ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) != 0) {
+    // viewport windows are drawn and presented with the main window instead of one by one by the backend
+    auto& platform_io = ImGui::GetPlatformIO();
+    backend_destroy_window_ = platform_io.Renderer_DestroyWindow;
+    platform_io.Renderer_CreateWindow = create_viewport;
+    platform_io.Renderer_DestroyWindow = destroy_viewport;
+    platform_io.Renderer_SetWindowSize = resize_viewport;
+    platform_io.Renderer_RenderWindow = nullptr;
+    platform_io.Renderer_SwapBuffers = nullptr;
+  }
+#endif
+}
+
+// ImGui uses the descriptor set of a texture as its ID, requires 64 bit ImTextureID on 32 bit platforms
+[[nodiscard]] static auto to_texture_id(VkDescriptorSet descriptor_set) noexcept -> ImTextureID {
+  return std::bit_cast<ImTextureID>(descriptor_set);
+}
+
+[[nodiscard]] static auto to_descriptor_set(ImTextureID texture) noexcept -> VkDescriptorSet {
+  return std::bit_cast<VkDescriptorSet>(texture);
+}
+
+// Same interface as the shaders of the ImGui Vulkan backend so that its textures and descriptor sets work unchanged,
+// assembled by hand from:
+//
+// #version 450 core
+// layout(location = 0) in vec2 aPos;
+// layout(location = 1) in vec2 aUV;
+// layout(location = 2) in vec4 aColor;
+// layout(push_constant) uniform uPushConstant { vec2 uScale; vec2 uTranslate; } pc;
+// out gl_PerVertex { vec4 gl_Position; };
+// layout(location = 0) out vec4 outColor;
+// layout(location = 1) out vec2 outUV;
+// void main() {
+//   outColor = aColor;
+//   outUV = aUV;
+//   gl_Position = vec4(aPos * pc.uScale + pc.uTranslate, 0, 1);
+// }
+constexpr static std::array<std::uint32_t, 241> imgui_vertex_spv{
+    0x07230203, 0x00010000, 0x00000000, 0x0000002a, 0x00000000, 0x00020011, 0x00000001, 0x0003000e,
+    0x00000000, 0x00000001, 0x000b000f, 0x00000000, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002,
+    0x00000003, 0x00000004, 0x00000005, 0x00000006, 0x00000007, 0x00040047, 0x00000002, 0x0000001e,
+    0x00000000, 0x00040047, 0x00000003, 0x0000001e, 0x00000001, 0x00040047, 0x00000004, 0x0000001e,
+    0x00000002, 0x00040047, 0x00000005, 0x0000001e, 0x00000000, 0x00040047, 0x00000006, 0x0000001e,
+    0x00000001, 0x00050048, 0x00000008, 0x00000000, 0x0000000b, 0x00000000, 0x00030047, 0x00000008,
+    0x00000002, 0x00050048, 0x00000009, 0x00000000, 0x00000023, 0x00000000, 0x00050048, 0x00000009,
+    0x00000001, 0x00000023, 0x00000008, 0x00030047, 0x00000009, 0x00000002, 0x00020013, 0x0000000a,
+    0x00030021, 0x0000000b, 0x0000000a, 0x00030016, 0x0000000c, 0x00000020, 0x00040017, 0x0000000d,
+    0x0000000c, 0x00000002, 0x00040017, 0x0000000e, 0x0000000c, 0x00000004, 0x00040015, 0x0000000f,
+    0x00000020, 0x00000001, 0x0003001e, 0x00000008, 0x0000000e, 0x00040020, 0x00000010, 0x00000003,
+    0x00000008, 0x0004003b, 0x00000010, 0x00000007, 0x00000003, 0x00040020, 0x00000011, 0x00000001,
+    0x0000000d, 0x00040020, 0x00000012, 0x00000001, 0x0000000e, 0x00040020, 0x00000013, 0x00000003,
+    0x0000000d, 0x00040020, 0x00000014, 0x00000003, 0x0000000e, 0x0004003b, 0x00000011, 0x00000002,
+    0x00000001, 0x0004003b, 0x00000011, 0x00000003, 0x00000001, 0x0004003b, 0x00000012, 0x00000004,
+    0x00000001, 0x0004003b, 0x00000014, 0x00000005, 0x00000003, 0x0004003b, 0x00000013, 0x00000006,
+    0x00000003, 0x0004001e, 0x00000009, 0x0000000d, 0x0000000d, 0x00040020, 0x00000015, 0x00000009,
+    0x00000009, 0x0004003b, 0x00000015, 0x00000016, 0x00000009, 0x00040020, 0x00000017, 0x00000009,
+    0x0000000d, 0x0004002b, 0x0000000f, 0x00000018, 0x00000000, 0x0004002b, 0x0000000f, 0x00000019,
+    0x00000001, 0x0004002b, 0x0000000c, 0x0000001a, 0x00000000, 0x0004002b, 0x0000000c, 0x0000001b,
+    0x3f800000, 0x00050036, 0x0000000a, 0x00000001, 0x00000000, 0x0000000b, 0x000200f8, 0x0000001c,
+    0x0004003d, 0x0000000e, 0x0000001d, 0x00000004, 0x0003003e, 0x00000005, 0x0000001d, 0x0004003d,
+    0x0000000d, 0x0000001e, 0x00000003, 0x0003003e, 0x00000006, 0x0000001e, 0x0004003d, 0x0000000d,
+    0x0000001f, 0x00000002, 0x00050041, 0x00000017, 0x00000020, 0x00000016, 0x00000018, 0x0004003d,
+    0x0000000d, 0x00000021, 0x00000020, 0x00050085, 0x0000000d, 0x00000022, 0x0000001f, 0x00000021,
+    0x00050041, 0x00000017, 0x00000023, 0x00000016, 0x00000019, 0x0004003d, 0x0000000d, 0x00000024,
+    0x00000023, 0x00050081, 0x0000000d, 0x00000025, 0x00000022, 0x00000024, 0x00050051, 0x0000000c,
+    0x00000026, 0x00000025, 0x00000000, 0x00050051, 0x0000000c, 0x00000027, 0x00000025, 0x00000001,
+    0x00070050, 0x0000000e, 0x00000028, 0x00000026, 0x00000027, 0x0000001a, 0x0000001b, 0x00050041,
+    0x00000014, 0x00000029, 0x00000007, 0x00000018, 0x0003003e, 0x00000029, 0x00000028, 0x000100fd,
+    0x00010038,
+};
+
+// #version 450 core
+// layout(location = 0) out vec4 fColor;
+// layout(set = 0, binding = 0) uniform sampler2D sTexture;
+// layout(location = 0) in vec4 inColor;
+// layout(location = 1) in vec2 inUV;
+// void main() { fColor = inColor * texture(sTexture, inUV); }
+constexpr static std::array<std::uint32_t, 135> imgui_fragment_spv{
+    0x07230203, 0x00010000, 0x00000000, 0x00000017, 0x00000000, 0x00020011, 0x00000001, 0x0003000e,
+    0x00000000, 0x00000001, 0x0008000f, 0x00000004, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002,
+    0x00000003, 0x00000004, 0x00030010, 0x00000001, 0x00000007, 0x00040047, 0x00000002, 0x0000001e,
+    0x00000000, 0x00040047, 0x00000003, 0x0000001e, 0x00000000, 0x00040047, 0x00000004, 0x0000001e,
+    0x00000001, 0x00040047, 0x00000005, 0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021,
+    0x00000000, 0x00020013, 0x00000006, 0x00030021, 0x00000007, 0x00000006, 0x00030016, 0x00000008,
+    0x00000020, 0x00040017, 0x00000009, 0x00000008, 0x00000002, 0x00040017, 0x0000000a, 0x00000008,
+    0x00000004, 0x00040020, 0x0000000b, 0x00000003, 0x0000000a, 0x0004003b, 0x0000000b, 0x00000002,
+    0x00000003, 0x00040020, 0x0000000c, 0x00000001, 0x0000000a, 0x0004003b, 0x0000000c, 0x00000003,
+    0x00000001, 0x00040020, 0x0000000d, 0x00000001, 0x00000009, 0x0004003b, 0x0000000d, 0x00000004,
+    0x00000001, 0x00090019, 0x0000000e, 0x00000008, 0x00000001, 0x00000000, 0x00000000, 0x00000000,
+    0x00000001, 0x00000000, 0x0003001b, 0x0000000f, 0x0000000e, 0x00040020, 0x00000010, 0x00000000,
+    0x0000000f, 0x0004003b, 0x00000010, 0x00000005, 0x00000000, 0x00050036, 0x00000006, 0x00000001,
+    0x00000000, 0x00000007, 0x000200f8, 0x00000011, 0x0004003d, 0x0000000a, 0x00000012, 0x00000003,
+    0x0004003d, 0x0000000f, 0x00000013, 0x00000005, 0x0004003d, 0x00000009, 0x00000014, 0x00000004,
+    0x00050057, 0x0000000a, 0x00000015, 0x00000013, 0x00000014, 0x00050085, 0x0000000a, 0x00000016,
+    0x00000012, 0x00000015, 0x0003003e, 0x00000002, 0x00000016, 0x000100fd, 0x00010038,
+};
+
+void Vulkan::build_pipeline(std::atomic<float>& milliseconds) {
+  pipeline_build_ = std::async(std::launch::async, [this, &milliseconds, render_pass = main_window_data_.RenderPass,
+                                                    samples = msaa_samples_]() {
+    TraceZone zone("Vulkan::build_pipeline");
+    auto const start = std::chrono::steady_clock::now();
+    update_pipeline(render_pass, samples, pipeline_, pipeline_render_pass_);
+    milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+  });
+}
+
+void Vulkan::wait_for_pipeline() {
+  if (pipeline_build_.valid()) pipeline_build_.get();
+}
+
+void Vulkan::update_pipeline(VkRenderPass render_pass, VkSampleCountFlagBits samples, VkPipeline& pipeline,
+                             VkRenderPass& pipeline_render_pass) {
+  if (pipeline_render_pass == render_pass) return;
+  VkResult err;
+  if (vertex_shader_ == nullptr) {
+    VkShaderModuleCreateInfo vertex_info{
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = sizeof(imgui_vertex_spv),
+        .pCode = imgui_vertex_spv.data(),
+    };
+    err = vkCreateShaderModule(device_, &vertex_info, allocator_, &vertex_shader_);
+    check_vk_result(err);
+    VkShaderModuleCreateInfo fragment_info{
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = sizeof(imgui_fragment_spv),
+        .pCode = imgui_fragment_spv.data(),
+    };
+    err = vkCreateShaderModule(device_, &fragment_info, allocator_, &fragment_shader_);
+    check_vk_result(err);
+
+    // scale and translation
+    VkPushConstantRange push_constants{
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = 4 * sizeof(float),
+    };
+    auto const set_layout = shared_device_->descriptors_.layout();
+    VkPipelineLayoutCreateInfo layout_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constants,
+    };
+    err = vkCreatePipelineLayout(device_, &layout_info, allocator_, &pipeline_layout_);
+    check_vk_result(err);
+  }
+
+  std::array<VkPipelineShaderStageCreateInfo, 2> stages{{
+      {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+          .stage = VK_SHADER_STAGE_VERTEX_BIT,
+          .module = vertex_shader_,
+          .pName = "main",
+      },
+      {
+          .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+          .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+          .module = fragment_shader_,
+          .pName = "main",
+      },
+  }};
+  VkVertexInputBindingDescription binding{
+      .binding = 0,
+      .stride = sizeof(ImDrawVert),
+      .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+  };
+  std::array<VkVertexInputAttributeDescription, 3> attributes{{
+      {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(ImDrawVert, pos)},
+      {.location = 1, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(ImDrawVert, uv)},
+      {.location = 2, .binding = 0, .format = VK_FORMAT_R8G8B8A8_UNORM, .offset = offsetof(ImDrawVert, col)},
+  }};
+  VkPipelineVertexInputStateCreateInfo vertex_input{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+      .vertexBindingDescriptionCount = 1,
+      .pVertexBindingDescriptions = &binding,
+      .vertexAttributeDescriptionCount = static_cast<std::uint32_t>(attributes.size()),
+      .pVertexAttributeDescriptions = attributes.data(),
+  };
+  VkPipelineInputAssemblyStateCreateInfo input_assembly{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+      .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+  };
+  VkPipelineViewportStateCreateInfo viewport{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+      .viewportCount = 1,
+      .scissorCount = 1,
+  };
+  VkPipelineRasterizationStateCreateInfo rasterization{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+      .polygonMode = VK_POLYGON_MODE_FILL,
+      .cullMode = VK_CULL_MODE_NONE,
+      .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+      .lineWidth = 1.0f,
+  };
+  VkPipelineMultisampleStateCreateInfo multisample{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+      .rasterizationSamples = samples,
+  };
+  // premultiplied output alpha like the backend
+  VkPipelineColorBlendAttachmentState blend_attachment{
+      .blendEnable = VK_TRUE,
+      .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+      .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+      .colorBlendOp = VK_BLEND_OP_ADD,
+      .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+      .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+      .alphaBlendOp = VK_BLEND_OP_ADD,
+      .colorWriteMask =
+          VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+  };
+  VkPipelineColorBlendStateCreateInfo blend{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+      .attachmentCount = 1,
+      .pAttachments = &blend_attachment,
+  };
+  constexpr static std::array<VkDynamicState, 2> dynamic_states{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+  VkPipelineDynamicStateCreateInfo dynamic_state{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+      .dynamicStateCount = static_cast<std::uint32_t>(dynamic_states.size()),
+      .pDynamicStates = dynamic_states.data(),
+  };
+  VkGraphicsPipelineCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+      .stageCount = static_cast<std::uint32_t>(stages.size()),
+      .pStages = stages.data(),
+      .pVertexInputState = &vertex_input,
+      .pInputAssemblyState = &input_assembly,
+      .pViewportState = &viewport,
+      .pRasterizationState = &rasterization,
+      .pMultisampleState = &multisample,
+      .pColorBlendState = &blend,
+      .pDynamicState = &dynamic_state,
+      .layout = pipeline_layout_,
+      .renderPass = render_pass,
+      .subpass = 0,
+  };
+  // a new render pass only comes with a new swap chain which waits for the device to be idle
+  vkDestroyPipeline(device_, pipeline, allocator_);
+  pipeline = nullptr;
+  err = vkCreateGraphicsPipelines(device_, pipeline_cache_, 1, &info, allocator_, &pipeline);
+  check_vk_result(err);
+  pipeline_render_pass = render_pass;
+}
+
+// the index buffer offset has to be a multiple of the index size
+constexpr static VkDeviceSize geometry_alignment = 16;
+constexpr static VkDeviceSize initial_geometry_size = 1024 * 1024;
+
+void Vulkan::create_geometry_ring(bool device_local) {
+  geometry_device_local_ = device_local;
+  reserve_geometry(initial_geometry_size);
+}
+
+void Vulkan::reserve_geometry(VkDeviceSize size) {
+  if (geometry_.buffer != nullptr) {
+    // frames in flight may still read from the old ring, their positions are meaningless in the new one. The ring
+    // can also grow while the viewports are recorded after the main window draws that bind the old buffer, so the
+    // frame being recorded is the last one that may use it
+    defer_destroy(ObjectType::buffer, geometry_.buffer, frame_counter_ + 1);
+    defer_destroy(ObjectType::memory, geometry_.memory, frame_counter_ + 1);
+    for (auto& frame : frames_) frame.geometry_end = 0;
+  }
+  geometry_ = {.size = std::bit_ceil(size)};
+  void* mapped;
+  create_host_buffer(geometry_.size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                     geometry_device_local_, geometry_.buffer, geometry_.memory, &mapped);
+  geometry_.mapped = static_cast<std::byte*>(mapped);
+}
+
+void Vulkan::destroy_geometry() {
+  // only called once the device is idle and the deferred objects are gone
+  vkDestroyBuffer(device_, geometry_.buffer, allocator_);
+  vkFreeMemory(device_, geometry_.memory, allocator_);
+  geometry_ = {};
+  vkDestroyPipeline(device_, pipeline_, allocator_);
+  vkDestroyPipelineLayout(device_, pipeline_layout_, allocator_);
+  vkDestroyShaderModule(device_, vertex_shader_, allocator_);
+  vkDestroyShaderModule(device_, fragment_shader_, allocator_);
+  pipeline_ = nullptr;
+  pipeline_layout_ = nullptr;
+  vertex_shader_ = nullptr;
+  fragment_shader_ = nullptr;
+  pipeline_render_pass_ = nullptr;
+}
+
+void Vulkan::setup_render_state(ImDrawData const* draw_data, VkCommandBuffer command_buffer,
+                                FrameGeometry const& geometry) {
+  vk_->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, geometry.pipeline);
+  if (draw_data->TotalVtxCount > 0) {
+    vk_->vkCmdBindVertexBuffers(command_buffer, 0, 1, &geometry_.buffer, &geometry.vertex_offset);
+    vk_->vkCmdBindIndexBuffer(command_buffer, geometry_.buffer, geometry.index_offset,
+                              sizeof(ImDrawIdx) == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+  }
+  VkViewport viewport{
+      .x = 0,
+      .y = 0,
+      .width = static_cast<float>(geometry.fb_width),
+      .height = static_cast<float>(geometry.fb_height),
+      .minDepth = 0.0f,
+      .maxDepth = 1.0f,
+  };
+  vk_->vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+  // map the display rectangle to clip space
+  std::array<float, 4> transform;
+  transform[0] = 2.0f / draw_data->DisplaySize.x;
+  transform[1] = 2.0f / draw_data->DisplaySize.y;
+  transform[2] = -1.0f - draw_data->DisplayPos.x * transform[0];
+  transform[3] = -1.0f - draw_data->DisplayPos.y * transform[1];
+  vk_->vkCmdPushConstants(command_buffer, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(transform),
+                          transform.data());
+}
+
+auto Vulkan::allocate_geometry(ImDrawData const* draw_data, FrameContext& frame, VkPipeline pipeline)
+    -> FrameGeometry {
+  // scale coordinates for retina displays
+  FrameGeometry geometry{
+      .pipeline = pipeline,
+      .fb_width = static_cast<int>(draw_data->DisplaySize.x * draw_data->FramebufferScale.x),
+      .fb_height = static_cast<int>(draw_data->DisplaySize.y * draw_data->FramebufferScale.y),
+  };
+  if (geometry.fb_width <= 0 || geometry.fb_height <= 0 || draw_data->TotalVtxCount <= 0) return geometry;
+
+  auto const vertex_bytes = (static_cast<VkDeviceSize>(draw_data->TotalVtxCount) * sizeof(ImDrawVert) +
+                             geometry_alignment - 1) / geometry_alignment * geometry_alignment;
+  auto const bytes = vertex_bytes + static_cast<VkDeviceSize>(draw_data->TotalIdxCount) * sizeof(ImDrawIdx);
+  geometry_high_water_ = std::max(geometry_high_water_, bytes);
+  auto offset = geometry_.allocate(bytes, geometry_alignment);
+  if (!offset) {
+    // grow geometrically, large enough for every frame in flight at the high water mark
+    reserve_geometry(std::max(2 * geometry_.size, geometry_high_water_ * (frames_.size() + 1)));
+    offset = geometry_.allocate(bytes, geometry_alignment);
+  }
+  geometry.vertex_offset = *offset;
+  geometry.index_offset = *offset + vertex_bytes;
+  frame.geometry_end = geometry_.head;
+  return geometry;
+}
+
+void Vulkan::copy_geometry(ImDrawData const* draw_data, FrameGeometry const& geometry, DrawRange const& range) {
+  // coherent memory, no flush needed
+  auto* vertices = geometry_.mapped + geometry.vertex_offset + range.vertex * sizeof(ImDrawVert);
+  auto* indices = geometry_.mapped + geometry.index_offset + range.index * sizeof(ImDrawIdx);
+  for (int i = range.first_list; i < range.last_list; ++i) {
+    ImDrawList const* list = draw_data->CmdLists[i];
+    auto const vertex_bytes = static_cast<std::size_t>(list->VtxBuffer.size_in_bytes());
+    auto const index_bytes = static_cast<std::size_t>(list->IdxBuffer.size_in_bytes());
+    std::memcpy(vertices, list->VtxBuffer.Data, vertex_bytes);
+    std::memcpy(indices, list->IdxBuffer.Data, index_bytes);
+    vertices += vertex_bytes;
+    indices += index_bytes;
+  }
+}
+
+void Vulkan::record_draw_lists(ImDrawData const* draw_data, VkCommandBuffer command_buffer,
+                               FrameGeometry const& geometry, DrawRange const& range) {
+  setup_render_state(draw_data, command_buffer, geometry);
+
+  // project clip rectangles into framebuffer space
+  ImVec2 const clip_offset = draw_data->DisplayPos;
+  ImVec2 const clip_scale = draw_data->FramebufferScale;
+  auto const fb_width = static_cast<float>(geometry.fb_width);
+  auto const fb_height = static_cast<float>(geometry.fb_height);
+  std::uint32_t global_vertex_offset = range.vertex;
+  std::uint32_t global_index_offset = range.index;
+  VkDescriptorSet bound_set = nullptr;
+  for (int i = range.first_list; i < range.last_list; ++i) {
+    ImDrawList const* list = draw_data->CmdLists[i];
+    for (ImDrawCmd const& cmd : list->CmdBuffer) {
+      if (cmd.UserCallback != nullptr) {
+        if (cmd.UserCallback == ImDrawCallback_ResetRenderState) {
+          setup_render_state(draw_data, command_buffer, geometry);
+          bound_set = nullptr;
+        } else {
+          cmd.UserCallback(list, &cmd);
+        }
+        continue;
+      }
+
+      ImVec2 const clip_min(std::max((cmd.ClipRect.x - clip_offset.x) * clip_scale.x, 0.0f),
+                            std::max((cmd.ClipRect.y - clip_offset.y) * clip_scale.y, 0.0f));
+      ImVec2 const clip_max(std::min((cmd.ClipRect.z - clip_offset.x) * clip_scale.x, fb_width),
+                            std::min((cmd.ClipRect.w - clip_offset.y) * clip_scale.y, fb_height));
+      if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y) continue;
+      VkRect2D scissor{
+          .offset = {static_cast<std::int32_t>(clip_min.x), static_cast<std::int32_t>(clip_min.y)},
+          .extent = {static_cast<std::uint32_t>(clip_max.x - clip_min.x),
+                     static_cast<std::uint32_t>(clip_max.y - clip_min.y)},
+      };
+      vk_->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+      // consecutive commands mostly sample the font atlas
+      if (auto* set = to_descriptor_set(cmd.GetTexID()); set != bound_set) {
+        vk_->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, 0, 1, &set, 0,
+                                     nullptr);
+        bound_set = set;
+      }
+      vk_->vkCmdDrawIndexed(command_buffer, cmd.ElemCount, 1, cmd.IdxOffset + global_index_offset,
+                            static_cast<std::int32_t>(cmd.VtxOffset + global_vertex_offset), 0);
+    }
+    global_vertex_offset += static_cast<std::uint32_t>(list->VtxBuffer.Size);
+    global_index_offset += static_cast<std::uint32_t>(list->IdxBuffer.Size);
+  }
+}
+
+void Vulkan::render_draw_data(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameContext& frame,
+                              VkPipeline pipeline) {
+  auto const geometry = allocate_geometry(draw_data, frame, pipeline);
+  if (geometry.fb_width <= 0 || geometry.fb_height <= 0) return;
+  DrawRange const range{.first_list = 0, .last_list = draw_data->CmdListsCount};
+  copy_geometry(draw_data, geometry, range);
+  record_draw_lists(draw_data, command_buffer, geometry, range);
+}
+
+void Vulkan::set_parallel_recording(ParallelRecording const& options) {
+  parallel_recording_ = options;
+  workers_ = options.threads > 0 ? std::make_unique<RecordingWorkers>(options.threads) : nullptr;
+}
+
+auto Vulkan::use_parallel_recording(ImDrawData const* draw_data) const noexcept -> bool {
+  if (workers_ == nullptr || draw_data->CmdListsCount < 2 || draw_data->TotalVtxCount <= 0 ||
+      static_cast<std::uint32_t>(draw_data->TotalVtxCount) < parallel_recording_.min_vertices) {
+    return false;
+  }
+  // user callbacks expect to be called in order on the rendering thread
+  for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+    for (ImDrawCmd const& cmd : draw_data->CmdLists[i]->CmdBuffer) {
+      if (cmd.UserCallback != nullptr && cmd.UserCallback != ImDrawCallback_ResetRenderState) return false;
+    }
+  }
+  return true;
+}
+
+auto Vulkan::split_draw_lists(ImDrawData const* draw_data, std::uint32_t max_ranges) -> std::uint32_t {
+  // balance the ranges by the amount of geometry, which is what the recording and copying time scales with
+  auto const ranges = std::min<std::size_t>(max_ranges, static_cast<std::size_t>(draw_data->CmdListsCount));
+  auto const total =
+      static_cast<std::size_t>(draw_data->TotalVtxCount) + static_cast<std::size_t>(draw_data->TotalIdxCount);
+  draw_ranges_.clear();
+  DrawRange range;
+  std::size_t done = 0;
+  std::uint32_t vertex = 0;
+  std::uint32_t index = 0;
+  for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+    ImDrawList const* list = draw_data->CmdLists[i];
+    vertex += static_cast<std::uint32_t>(list->VtxBuffer.Size);
+    index += static_cast<std::uint32_t>(list->IdxBuffer.Size);
+    done += static_cast<std::size_t>(list->VtxBuffer.Size) + static_cast<std::size_t>(list->IdxBuffer.Size);
+    range.last_list = i + 1;
+    bool const last = i + 1 == draw_data->CmdListsCount;
+    if (last || (draw_ranges_.size() + 1 < ranges && done * ranges >= total * (draw_ranges_.size() + 1))) {
+      draw_ranges_.push_back(range);
+      range = {.first_list = i + 1, .last_list = i + 1, .vertex = vertex, .index = index};
+    }
+  }
+  return static_cast<std::uint32_t>(draw_ranges_.size());
+}
+
+void Vulkan::create_secondary_command_buffers(FrameContext& frame, std::uint32_t count) {
+  VkResult err;
+  while (frame.secondary_pools.size() < count) {
+    VkCommandPoolCreateInfo pool_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queue_family_,
+    };
+    VkCommandPool pool;
+    err = vkCreateCommandPool(device_, &pool_info, allocator_, &pool);
+    check_vk_result(err);
+    frame.secondary_pools.push_back(pool);
+
+    VkCommandBufferAllocateInfo buffer_info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1,
+    };
+    VkCommandBuffer command_buffer;
+    err = vkAllocateCommandBuffers(device_, &buffer_info, &command_buffer);
+    check_vk_result(err);
+    frame.secondary_command_buffers.push_back(command_buffer);
+  }
+}
+
+void Vulkan::record_parallel(ImDrawData const* draw_data, VkCommandBuffer command_buffer, FrameContext& frame,
+                             VkRenderPass render_pass, VkFramebuffer framebuffer) {
+  auto const geometry = allocate_geometry(draw_data, frame, pipeline_);
+  if (geometry.fb_width <= 0 || geometry.fb_height <= 0) return;
+  auto const count = split_draw_lists(draw_data, workers_->size());
+  create_secondary_command_buffers(frame, count);
+
+  VkCommandBufferInheritanceInfo inheritance{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .renderPass = render_pass,
+      .subpass = 0,
+      .framebuffer = framebuffer,
+  };
+  // each worker copies its own draw lists into the ring before recording them
+  workers_->run(count, [&](std::uint32_t i) {
+    auto const& range = draw_ranges_[i];
+    copy_geometry(draw_data, geometry, range);
+
+    auto err = vk_->vkResetCommandPool(device_, frame.secondary_pools[i], 0);
+    check_vk_result(err);
+    VkCommandBufferBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritance,
+    };
+    auto* secondary = frame.secondary_command_buffers[i];
+    err = vk_->vkBeginCommandBuffer(secondary, &info);
+    check_vk_result(err);
+    record_draw_lists(draw_data, secondary, geometry, range);
+    err = vk_->vkEndCommandBuffer(secondary);
+    check_vk_result(err);
+  });
+  vk_->vkCmdExecuteCommands(command_buffer, count, frame.secondary_command_buffers.data());
+}
+
+void Vulkan::update_viewports() {
+#ifdef IMGUI_HAS_VIEWPORT
+  if ((ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) == 0) return;
+  updating_viewports_ = this;
+  scope_guard guard([]() { updating_viewports_ = nullptr; });
+  ImGui::UpdatePlatformWindows();
+#endif
+}
+
+#ifdef IMGUI_HAS_VIEWPORT
+void Vulkan::create_viewport(ImGuiViewport* viewport) {
+  auto* vulkan = updating_viewports_;
+  auto window = std::make_unique<ViewportWindow>();
+  window->vulkan = vulkan;
+  window->viewport = viewport;
+  window->window.ClearEnable = (viewport->Flags & ImGuiViewportFlags_NoRendererClear) == 0;
+
+  VkSurfaceKHR surface;
+  vulkan->create_surface(static_cast<SDL_Window*>(viewport->PlatformHandle), &surface);
+  window->window.Surface = surface;
+  viewport->RendererUserData = window.get();
+  vulkan->viewports_.push_back(std::move(window));
+  auto& created = *vulkan->viewports_.back();
+
+  // same surface format and present mode as the main window, sized in pixels
+  int width, height;
+  SDL_Vulkan_GetDrawableSize(static_cast<SDL_Window*>(viewport->PlatformHandle), &width, &height);
+  vulkan->setup_window(&created.window, surface, width, height);
+  created.window.FrameIndex = 0;
+  created.image_acquired.resize(vulkan->frames_.size());
+  for (auto& semaphore : created.image_acquired) {
+    VkSemaphoreCreateInfo info{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    auto err = vkCreateSemaphore(vulkan->device_, &info, vulkan->allocator_, &semaphore);
+    check_vk_result(err);
+  }
+}
+
+void Vulkan::destroy_viewport(ImGuiViewport* viewport) {
+  if (viewport == ImGui::GetMainViewport()) {
+    if (backend_destroy_window_ != nullptr) backend_destroy_window_(viewport);
+    return;
+  }
+  if (auto* window = static_cast<ViewportWindow*>(viewport->RendererUserData); window != nullptr) {
+    window->vulkan->destroy_viewport_window(*window);
+  }
+  viewport->RendererUserData = nullptr;
+}
+
+void Vulkan::resize_viewport(ImGuiViewport* viewport, ImVec2 size) {
+  if (viewport == ImGui::GetMainViewport()) return;
+  if (auto* window = static_cast<ViewportWindow*>(viewport->RendererUserData); window != nullptr) {
+    // the size is in points, the swap chain needs pixels on high DPI displays
+    int width = static_cast<int>(size.x), height = static_cast<int>(size.y);
+    if (viewport->PlatformHandle != nullptr) {
+      SDL_Vulkan_GetDrawableSize(static_cast<SDL_Window*>(viewport->PlatformHandle), &width, &height);
+    }
+    window->vulkan->resize_viewport_window(*window, width, height);
+  }
+}
+
+void Vulkan::resize_viewport_window(ViewportWindow& viewport, int width, int height) {
+  if (width <= 0 || height <= 0) return;
+  viewport.window.ClearEnable = (viewport.viewport->Flags & ImGuiViewportFlags_NoRendererClear) == 0;
+  select_present_mode(&viewport.window);
+  // waits for the device to be idle
+  auto lock = lock_queue();
+  ImGui_ImplVulkanH_CreateOrResizeWindow(instance_, physical_device_, device_, &viewport.window, queue_family_,
+                                         allocator_, width, height, min_image_count_);
+  viewport.window.FrameIndex = 0;
+  viewport.rebuild = false;
+}
+
+void Vulkan::destroy_viewport_window(ViewportWindow& viewport) {
+  wait_idle();
+  for (auto* semaphore : viewport.image_acquired) vkDestroySemaphore(device_, semaphore, allocator_);
+  vkDestroyPipeline(device_, viewport.pipeline, allocator_);
+  // SDL creates the surface without allocation callbacks so it has to be destroyed without them too
+  auto surface = std::exchange(viewport.window.Surface, nullptr);
+  {
+    auto lock = lock_queue();
+    ImGui_ImplVulkanH_DestroyWindow(instance_, device_, &viewport.window, allocator_);
+  }
+  vkDestroySurfaceKHR(instance_, surface, nullptr);
+  std::erase_if(viewports_, [&](auto const& window) { return window.get() == &viewport; });
+}
+
+void Vulkan::record_viewports(std::uint32_t slot, FrameContext& frame) {
+  for (auto& viewport : viewports_) {
+    viewport->acquired = false;
+    auto* sdl_window = static_cast<SDL_Window*>(viewport->viewport->PlatformHandle);
+    ImDrawData const* draw_data = viewport->viewport->DrawData;
+    if (draw_data == nullptr || (SDL_GetWindowFlags(sdl_window) & SDL_WINDOW_MINIMIZED) != 0) continue;
+
+    auto& window = viewport->window;
+    if (viewport->rebuild) {
+      int width, height;
+      SDL_Vulkan_GetDrawableSize(sdl_window, &width, &height);
+      resize_viewport_window(*viewport, width, height);
+      if (viewport->rebuild) continue;
+    }
+    auto err = vk_->vkAcquireNextImageKHR(device_, window.Swapchain, std::numeric_limits<std::uint64_t>::max(),
+                                          viewport->image_acquired[slot], nullptr, &window.FrameIndex);
+    if (err == VK_ERROR_OUT_OF_DATE_KHR) {
+      viewport->rebuild = true;
+      continue;
+    }
+    if (err != VK_SUBOPTIMAL_KHR) check_vk_result(err);
+    viewport->acquired = true;
+
+    // viewport windows use the single sampled render pass of the backend
+    update_pipeline(window.RenderPass, VK_SAMPLE_COUNT_1_BIT, viewport->pipeline, viewport->pipeline_render_pass);
+    VkRenderPassBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = window.RenderPass,
+        .framebuffer = window.Frames[window.FrameIndex].Framebuffer,
+        .renderArea =
+            {
+                .extent =
+                    {
+                        .width = static_cast<std::uint32_t>(window.Width),
+                        .height = static_cast<std::uint32_t>(window.Height),
+                    },
+            },
+        .clearValueCount = 1,
+        .pClearValues = &window.ClearValue,
+    };
+    vk_->vkCmdBeginRenderPass(frame.command_buffer, &info, VK_SUBPASS_CONTENTS_INLINE);
+    render_draw_data(draw_data, frame.command_buffer, frame, viewport->pipeline);
+    vk_->vkCmdEndRenderPass(frame.command_buffer);
+  }
+}
+#endif
+
+auto Vulkan::frame_unchanged(ImGui_ImplVulkanH_Window const* wd, ImDrawData const* draw_data) -> bool {
+  damage_.clear();
+#ifdef IMGUI_HAS_VIEWPORT
+  // only the main viewport is hashed, viewport windows are always redrawn
+  if (!viewports_.empty()) return false;
+#endif
+  VkExtent2D const extent{static_cast<std::uint32_t>(wd->Width), static_cast<std::uint32_t>(wd->Height)};
+  if (!frame_hash_.compute(*draw_data, wd->ClearValue, extent)) {
+    presented_hash_valid_ = false;
+    return false;
+  }
+  // the swap chain images have to be redrawn after recreation
+  if (presented_hash_valid_ && !swap_chain_rebuild_ && frame_hash_ == presented_hash_) return true;
+
+  // the compositor only needs to update the draw lists that changed, in both the old and the new frame
+  if (incremental_present_ && presented_hash_valid_ && frame_hash_.header == presented_hash_.header) {
+    auto const count = std::max(frame_hash_.lists.size(), presented_hash_.lists.size());
+    for (std::size_t i = 0; i < count; ++i) {
+      bool const in_frame = i < frame_hash_.lists.size();
+      bool const in_presented = i < presented_hash_.lists.size();
+      if (in_frame && in_presented && frame_hash_.lists[i] == presented_hash_.lists[i]) continue;
+      if (in_frame) damage_.push_back(frame_hash_.bounds[i]);
+      if (in_presented) damage_.push_back(presented_hash_.bounds[i]);
+    }
+    std::erase_if(damage_, [](auto const& rect) { return rect.extent.width == 0 || rect.extent.height == 0; });
+    // too many rectangles cost the compositor more than they save
+    if (damage_.size() > max_damage_rects) {
+      auto x0 = std::numeric_limits<std::int32_t>::max();
+      auto y0 = std::numeric_limits<std::int32_t>::max();
+      std::int32_t x1 = 0;
+      std::int32_t y1 = 0;
+      for (auto const& rect : damage_) {
+        x0 = std::min(x0, rect.offset.x);
+        y0 = std::min(y0, rect.offset.y);
+        x1 = std::max(x1, rect.offset.x + static_cast<std::int32_t>(rect.extent.width));
+        y1 = std::max(y1, rect.offset.y + static_cast<std::int32_t>(rect.extent.height));
+      }
+      damage_.assign(1, {.offset = {x0, y0},
+                         .extent = {static_cast<std::uint32_t>(x1 - x0), static_cast<std::uint32_t>(y1 - y0)}});
+    }
+  }
+  std::swap(presented_hash_, frame_hash_);
+  presented_hash_valid_ = true;
+  frame_hashed_ = true;
+  return false;
+}
+
+void Vulkan::present_frame(ImGui_ImplVulkanH_Window* wd, PhaseTimer& timer) {
+  if (swap_chain_rebuild_ || headless_) return;
+  TraceZone zone("Vulkan::present_frame");
+  // the main window first, followed by all viewport windows in a single present
+  present_waits_.assign(1, wd->FrameSemaphores[wd->FrameIndex].RenderCompleteSemaphore);
+  present_swapchains_.assign(1, wd->Swapchain);
+  present_images_.assign(1, wd->FrameIndex);
+  present_regions_.assign(1, {
+                                 .rectangleCount = static_cast<std::uint32_t>(damage_.size()),
+                                 .pRectangles = damage_.data(),
+                             });
+#ifdef IMGUI_HAS_VIEWPORT
+  for (auto const& viewport : viewports_) {
+    if (!viewport->acquired) continue;
+    auto const& window = viewport->window;
+    present_waits_.push_back(window.FrameSemaphores[window.FrameIndex].RenderCompleteSemaphore);
+    present_swapchains_.push_back(window.Swapchain);
+    present_images_.push_back(window.FrameIndex);
+    // no rectangles means that the whole image changed
+    present_regions_.push_back({});
+  }
+#endif
+  auto const count = static_cast<std::uint32_t>(present_swapchains_.size());
+  present_results_.assign(count, VK_SUCCESS);
+  VkPresentRegionsKHR regions{
+      .sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR,
+      .swapchainCount = count,
+      .pRegions = present_regions_.data(),
+  };
+  // no regions means that the whole image changed
+  void const* next = damage_.empty() ? nullptr : &regions;
+  VkPresentIdKHR ids{.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+  if (wait_for_present_ != nullptr) {
+    // the frame was counted by render_frame, viewport windows are presented without an id
+    frames_[(frame_counter_ - 1) % frames_.size()].present_id = ++present_id_;
+    present_ids_.assign(count, 0);
+    present_ids_[0] = present_id_;
+    ids.pNext = next;
+    ids.swapchainCount = count;
+    ids.pPresentIds = present_ids_.data();
+    next = &ids;
+  }
+  VkPresentInfoKHR info{
+      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+      .pNext = next,
+      .waitSemaphoreCount = count,
+      .pWaitSemaphores = present_waits_.data(),
+      .swapchainCount = count,
+      .pSwapchains = present_swapchains_.data(),
+      .pImageIndices = present_images_.data(),
+      .pResults = present_results_.data(),
+  };
+  VkResult err;
+  {
+    auto lock = lock_queue();
+    err = vk_->vkQueuePresentKHR(queue_, &info);
+  }
+  timer.mark(FramePhase::present);
+  if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
+    swap_chain_rebuild_ =
+        present_results_[0] == VK_ERROR_OUT_OF_DATE_KHR || present_results_[0] == VK_SUBOPTIMAL_KHR;
+#ifdef IMGUI_HAS_VIEWPORT
+    std::uint32_t i = 1;
+    for (auto const& viewport : viewports_) {
+      if (!viewport->acquired) continue;
+      auto const result = present_results_[i++];
+      viewport->rebuild = viewport->rebuild || result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR;
+    }
+#endif
+    return;
+  }
+  check_vk_result(err);
+}
+
+void Vulkan::wait_for_frame() {
+  if (frames_.empty()) return;
+  auto& frame = frames_[frame_counter_ % frames_.size()];
+  if (frame.present_id != 0 && !swap_chain_rebuild_) {
+    // bounded since the image of a hidden window may never be displayed
+    constexpr static std::uint64_t timeout = 100'000'000;
+    auto const err = wait_for_present_(device_, main_window_data_.Swapchain, frame.present_id, timeout);
+    frame.present_id = 0;
+    if (err == VK_ERROR_OUT_OF_DATE_KHR || err == VK_SUBOPTIMAL_KHR) {
+      swap_chain_rebuild_ = true;
+    } else if (err != VK_TIMEOUT) {
+      check_vk_result(err);
+    }
+  }
+  // covers frames that were not presented or timed out, render_frame won't block after this
+  if (frame_counter_ >= frames_.size()) wait_for_frames(frame_counter_ - frames_.size() + 1);
+}
+
+auto Vulkan::completed_frames() -> std::uint64_t {
+  // the fences only tell about the frames that were waited for, polling them is left to wait_for_frames
+  if (timeline_ != nullptr && completed_frames_ < frame_counter_) {
+    std::uint64_t value;
+    auto const err = vk_->vkGetSemaphoreCounterValue(device_, timeline_, &value);
+    check_vk_result(err);
+    completed_frames_ = std::max(completed_frames_, value);
+  }
+  return completed_frames_;
+}
+
+void Vulkan::wait_for_frames(std::uint64_t count) {
+  count = std::min(count, frame_counter_);
+  if (count <= completed_frames_) return;
+  VkResult err;
+  if (timeline_ != nullptr) {
+    VkSemaphoreWaitInfo info{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &timeline_,
+        .pValues = &count,
+    };
+    err = vk_->vkWaitSemaphores(device_, &info, std::numeric_limits<std::uint64_t>::max());
+  } else {
+    // the slot still holds the fence of the last frame since older slot users were waited for before being reused,
+    // submissions to the same queue complete in order so the earlier frames are done as well
+    auto const& frame = frames_[(count - 1) % frames_.size()];
+    err = vk_->vkWaitForFences(device_, 1, &frame.fence, VK_TRUE, std::numeric_limits<std::uint64_t>::max());
+  }
+  check_vk_result(err);
+  completed_frames_ = count;
+}
+
+void Vulkan::render_frame(ImGui_ImplVulkanH_Window* wd, ImDrawData* draw_data, PhaseTimer& timer) {
+  TraceZone zone("Vulkan::render_frame");
+  VkResult err;
+  // frames that were not compared make the last presented hash stale and have no known damage
+  if (!frame_hashed_) {
+    presented_hash_valid_ = false;
+    damage_.clear();
+  }
+  frame_hashed_ = false;
+
+  auto const slot = static_cast<std::uint32_t>(frame_counter_ % frames_.size());
+  FrameContext& frame = frames_[slot];
+  // wait for the GPU to finish the last frame that used this slot, any newer frames can still be in flight
+  if (frame_counter_ >= frames_.size()) wait_for_frames(frame_counter_ - frames_.size() + 1);
+  timer.mark(FramePhase::fence_wait);
+  // the timeline may report newer frames as completed than the one waited for
+  auto const completed = completed_frames();
+  if (completed > 0) retire_uploads(completed - 1);
+  destroy_deferred(completed);
+  deliver_captures();
+  geometry_.release(frame.geometry_end);
+  frame.present_id = 0;
+
+  if (headless_) {
+    // offscreen images are simply used round robin
+    wd->FrameIndex = (wd->FrameIndex + 1) % wd->ImageCount;
+  } else {
+    err = vk_->vkAcquireNextImageKHR(device_, wd->Swapchain, std::numeric_limits<std::uint64_t>::max(),
+                                     frame.image_acquired, nullptr, &wd->FrameIndex);
+    timer.mark(FramePhase::acquire);
+    // suboptimal images are still acquired and have to be presented, the rebuild is flagged on present
+    if (err == VK_ERROR_OUT_OF_DATE_KHR) {
+      swap_chain_rebuild_ = true;
+      return;
+    }
+    if (err != VK_SUBOPTIMAL_KHR) check_vk_result(err);
+  }
+  // only reset once it is certain that a submission will signal it again
+  if (timeline_ == nullptr) {
+    err = vk_->vkResetFences(device_, 1, &frame.fence);
+    check_vk_result(err);
+  }
+
+  read_gpu_time(slot, timer.timings());
+  auto const scale = next_render_scale(frame, timer.timings().gpu);
+  timer.timings().render_scale = scale;
+  frame.render_scale = scale;
+  VkExtent2D const extent{static_cast<std::uint32_t>(wd->Width), static_cast<std::uint32_t>(wd->Height)};
+  bool const scaled = scale < 1;
+  if (scale != render_scale_) {
+    // the whole image changes with the scale, the damage regions only cover the draw data
+    damage_.clear();
+  } else if (scaled) {
+    // linear filtering spreads every changed pixel of the scaled image onto its neighbors
+    auto const pad = static_cast<std::int32_t>(std::ceil(2.0f / scale));
+    for (auto& rect : damage_) {
+      auto const x0 = std::max(rect.offset.x - pad, 0);
+      auto const y0 = std::max(rect.offset.y - pad, 0);
+      auto const x1 = std::min(rect.offset.x + static_cast<std::int32_t>(rect.extent.width) + pad, wd->Width);
+      auto const y1 = std::min(rect.offset.y + static_cast<std::int32_t>(rect.extent.height) + pad, wd->Height);
+      rect.offset = {x0, y0};
+      rect.extent = {static_cast<std::uint32_t>(x1 - x0), static_cast<std::uint32_t>(y1 - y0)};
+    }
+  }
+  render_scale_ = scale;
+  ImGui_ImplVulkanH_Frame* fd = &wd->Frames[wd->FrameIndex];
+  {
+    err = vk_->vkResetCommandPool(device_, frame.command_pool, 0);
+    check_vk_result(err);
+    VkCommandBufferBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VkCommandBufferUsageFlags{} | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    err = vk_->vkBeginCommandBuffer(frame.command_buffer, &info);
+    check_vk_result(err);
+  }
+  auto const query = 2 * slot;
+  if (gpu_timestamps && timestamp_pool_ != nullptr) {
+    vk_->vkCmdResetQueryPool(frame.command_buffer, timestamp_pool_, query, 2);
+  }
+  bool const wait_for_transfer = record_uploads(frame);
+  wait_for_pipeline();
+  update_pipeline(wd->RenderPass, msaa_samples_, pipeline_, pipeline_render_pass_);
+  bool const parallel = use_parallel_recording(draw_data);
+
+  // ImGui maps its coordinates through the framebuffer scale, shrinking it draws everything into the smaller area
+  VkExtent2D render_extent = extent;
+  VkRenderPass render_pass = wd->RenderPass;
+  VkFramebuffer framebuffer = fd->Framebuffer;
+  scope_guard scale_guard([draw_data, framebuffer_scale = draw_data->FramebufferScale]() {
+    draw_data->FramebufferScale = framebuffer_scale;
+  });
+  if (scaled) {
+    if (scaled_.image == nullptr) create_scaled_target(extent);
+    render_extent = {std::max(1u, static_cast<std::uint32_t>(static_cast<float>(extent.width) * scale)),
+                     std::max(1u, static_cast<std::uint32_t>(static_cast<float>(extent.height) * scale))};
+    render_pass = scaled_render_pass_;
+    framebuffer = scaled_.framebuffer;
+    draw_data->FramebufferScale.x *= static_cast<float>(render_extent.width) / static_cast<float>(extent.width);
+    draw_data->FramebufferScale.y *= static_cast<float>(render_extent.height) / static_cast<float>(extent.height);
+    // the blit of the previous frame has to be done reading the image before it is rendered to again
+    vk_->vkCmdPipelineBarrier(frame.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+  }
+
+  // outside of the render pass since render passes recorded from secondary command buffers can only execute them
+  if (gpu_timestamps && timestamp_pool_ != nullptr) {
+    vk_->vkCmdWriteTimestamp(frame.command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_pool_, query);
+  }
+  {
+    VkRenderPassBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .renderPass = render_pass,
+        .framebuffer = framebuffer,
+        .renderArea = {.extent = render_extent},
+        .clearValueCount = 1,
+        .pClearValues = &wd->ClearValue,
+    };
+    vk_->vkCmdBeginRenderPass(frame.command_buffer, &info,
+                              parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+  }
+
+  // Record dear imgui primitives into command buffer
+  if (parallel) {
+    record_parallel(draw_data, frame.command_buffer, frame, render_pass, framebuffer);
+  } else {
+    render_draw_data(draw_data, frame.command_buffer, frame, pipeline_);
+  }
+  vk_->vkCmdEndRenderPass(frame.command_buffer);
+  auto const final_layout = headless_ ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  if (scaled) record_upscale(frame.command_buffer, fd->Backbuffer, render_extent, extent, final_layout);
+  if (capture_all_.load(std::memory_order_relaxed) || capture_next_.exchange(false)) {
+    record_capture(frame, fd->Backbuffer, final_layout);
+  }
+#ifdef IMGUI_HAS_VIEWPORT
+  record_viewports(slot, frame);
+#endif
+  if (gpu_timestamps && timestamp_pool_ != nullptr) {
+    vk_->vkCmdWriteTimestamp(frame.command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_pool_, query + 1);
+    timestamps_written_[slot] = 1;
+  }
+
+  // Submit command buffer
+  err = vk_->vkEndCommandBuffer(frame.command_buffer);
+  check_vk_result(err);
+  timer.mark(FramePhase::record);
+  {
+    // nothing to synchronize with without a swap chain, render complete semaphores are per image since they are only
+    // known to be unused again once the image is acquired again
+    submit_waits_.clear();
+    submit_wait_stages_.clear();
+    submit_signals_.clear();
+    if (!headless_) {
+      submit_waits_.push_back(frame.image_acquired);
+      // a scaled frame only writes to the swap chain image with the blit
+      submit_wait_stages_.push_back(scaled ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                           : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+      submit_signals_.push_back(wd->FrameSemaphores[wd->FrameIndex].RenderCompleteSemaphore);
+    }
+    if (wait_for_transfer) {
+      // uploaded textures are only sampled by fragment shaders
+      submit_waits_.push_back(frame.transfer_complete);
+      submit_wait_stages_.push_back(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    }
+#ifdef IMGUI_HAS_VIEWPORT
+    for (auto const& viewport : viewports_) {
+      if (!viewport->acquired) continue;
+      submit_waits_.push_back(viewport->image_acquired[slot]);
+      submit_wait_stages_.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+      auto const& window = viewport->window;
+      submit_signals_.push_back(window.FrameSemaphores[window.FrameIndex].RenderCompleteSemaphore);
+    }
+#endif
+    // binary semaphores ignore their values, the timeline goes last
+    VkTimelineSemaphoreSubmitInfo timeline_info{.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    if (timeline_ != nullptr) {
+      submit_signal_values_.assign(submit_signals_.size(), 0);
+      submit_signals_.push_back(timeline_);
+      submit_signal_values_.push_back(frame_counter_ + 1);
+      timeline_info.signalSemaphoreValueCount = static_cast<std::uint32_t>(submit_signal_values_.size());
+      timeline_info.pSignalSemaphoreValues = submit_signal_values_.data();
+    }
+    VkSubmitInfo info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = timeline_ != nullptr ? &timeline_info : nullptr,
+        .waitSemaphoreCount = static_cast<std::uint32_t>(submit_waits_.size()),
+        .pWaitSemaphores = submit_waits_.data(),
+        .pWaitDstStageMask = submit_wait_stages_.data(),
+        .commandBufferCount = 1,
+        .pCommandBuffers = &frame.command_buffer,
+        .signalSemaphoreCount = static_cast<std::uint32_t>(submit_signals_.size()),
+        .pSignalSemaphores = submit_signals_.data(),
+    };
+
+    auto lock = lock_queue();
+    if constexpr (build_config.tracing) frame.submit_time = trace_time(std::chrono::steady_clock::now());
+    err = vk_->vkQueueSubmit(queue_, 1, &info, timeline_ != nullptr ? nullptr : frame.fence);
+    check_vk_result(err);
+  }
+  ++frame_counter_;
+  timer.mark(FramePhase::submit);
+}
+
+void Vulkan::cleanup() {
+  // a failed build leaves nothing behind that isn't destroyed below
+  if (pipeline_build_.valid()) pipeline_build_.wait();
+  // the shared objects are destroyed with the device once the last window using it is gone
+  destroy_frame_contexts();
+  destroy_textures();
+  destroy_geometry();
+  vkDestroyQueryPool(device_, timestamp_pool_, allocator_);
+  timestamp_pool_ = nullptr;
+  vkDestroyDescriptorPool(device_, backend_descriptor_pool_, allocator_);
+  backend_descriptor_pool_ = nullptr;
+  shared_device_ = nullptr;
+}
+
+void Vulkan::wait_idle() {
+  auto lock = lock_queue();
+  auto err = vkDeviceWaitIdle(device_);
+  check_vk_result(err);
+  completed_frames_ = frame_counter_;
+}
+
+void Vulkan::shutdown() {
+  wait_idle();
+#ifdef IMGUI_HAS_VIEWPORT
+  // the viewport windows use the device and have to be gone before the backend shuts down
+  updating_viewports_ = this;
+  scope_guard guard([]() { updating_viewports_ = nullptr; });
+  ImGui::DestroyPlatformWindows();
+#endif
+  ImGui_ImplVulkan_Shutdown();
+}
+
+// copy offsets into the ring have to be aligned to the texel size, use a generous alignment for faster copies
+constexpr static VkDeviceSize staging_alignment = 16;
+
+void Vulkan::create_host_buffer(VkDeviceSize size, VkBufferUsageFlags usage, bool device_local, VkBuffer& buffer,
+                                VkDeviceMemory& memory, void** mapped) {
+  VkBufferCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size = size,
+      .usage = usage,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  auto err = vkCreateBuffer(device_, &info, allocator_, &buffer);
+  check_vk_result(err);
+
+  // coherent so that writes never have to be flushed
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements(device_, buffer, &requirements);
+  constexpr static VkMemoryPropertyFlags host =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  std::optional<std::uint32_t> memory_type;
+  if (device_local) {
+    memory_type = try_find_memory_type(requirements.memoryTypeBits, host | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  }
+  VkMemoryAllocateInfo alloc_info{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .allocationSize = requirements.size,
+      .memoryTypeIndex = memory_type ? *memory_type : find_memory_type(requirements.memoryTypeBits, host),
+  };
+  err = vkAllocateMemory(device_, &alloc_info, allocator_, &memory);
+  check_vk_result(err);
+  err = vkBindBufferMemory(device_, buffer, memory, 0);
+  check_vk_result(err);
+  err = vkMapMemory(device_, memory, 0, size, 0, mapped);
+  check_vk_result(err);
+}
+
+void Vulkan::create_staging_ring(std::size_t size) {
+  staging_.size = std::max<VkDeviceSize>((size + staging_alignment - 1) / staging_alignment * staging_alignment,
+                                         staging_alignment);
+  void* mapped;
+  create_host_buffer(staging_.size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false, staging_.buffer, staging_.memory, &mapped);
+  staging_.mapped = static_cast<std::byte*>(mapped);
+
+  VkSamplerCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+      .magFilter = VK_FILTER_LINEAR,
+      .minFilter = VK_FILTER_LINEAR,
+      .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+      .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+      .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+      .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+      .maxAnisotropy = 1.0f,
+      .minLod = -1000,
+      .maxLod = 1000,
+  };
+  auto err = vkCreateSampler(device_, &info, allocator_, &texture_sampler_);
+  check_vk_result(err);
+}
+
+auto Vulkan::upload_texture(std::span<std::uint8_t const> rgba, int width, int height) -> ImTextureID {
+  auto const pixels = static_cast<std::size_t>(std::max(width, 0)) * static_cast<std::size_t>(std::max(height, 0));
+  if (pixels == 0 || rgba.size() != 4 * pixels) [[unlikely]] {
+    throw_gui_error("Invalid RGBA texture data of {} bytes for {}x{} texture", rgba.size(), width, height);
+  }
+
+  VkResult err;
+  Texture texture;
+  {
+    VkImageCreateInfo info{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .extent = {static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), 1},
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+    err = vkCreateImage(device_, &info, allocator_, &texture.image);
+    check_vk_result(err);
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device_, texture.image, &requirements);
+    VkMemoryAllocateInfo alloc_info{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    };
+    err = vkAllocateMemory(device_, &alloc_info, allocator_, &texture.memory);
+    check_vk_result(err);
+    err = vkBindImageMemory(device_, texture.image, texture.memory, 0);
+    check_vk_result(err);
+  }
+  {
+    VkImageViewCreateInfo info{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = texture.image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+    err = vkCreateImageView(device_, &info, allocator_, &texture.view);
+    check_vk_result(err);
+  }
+  VkDescriptorSet descriptor_set;
+  {
+    auto lock = lock_descriptor_pool();
+    descriptor_set = shared_device_->descriptors_.allocate();
+  }
+  {
+    VkDescriptorImageInfo image_info{
+        .sampler = texture_sampler_,
+        .imageView = texture.view,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    };
+    VkWriteDescriptorSet write{
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = descriptor_set,
+        .dstBinding = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &image_info,
+    };
+    vkUpdateDescriptorSets(device_, 1, &write, 0, nullptr);
+  }
+
+  Upload upload{
+      .image = texture.image,
+      .width = static_cast<std::uint32_t>(width),
+      .height = static_cast<std::uint32_t>(height),
+  };
+  std::lock_guard lock(upload_mutex_);
+  void* staging;
+  if (auto offset = staging_.allocate(rgba.size(), staging_alignment); offset) {
+    upload.buffer = staging_.buffer;
+    upload.offset = *offset;
+    upload.ring_end = staging_.head;
+    staging = staging_.mapped + *offset;
+  } else {
+    // too large or the ring is full of copies that are still in flight, don't wait for them
+    create_host_buffer(rgba.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, false, upload.buffer, upload.dedicated_memory,
+                       &staging);
+  }
+  std::memcpy(staging, rgba.data(), rgba.size());
+  if (upload.dedicated_memory != nullptr) vkUnmapMemory(device_, upload.dedicated_memory);
+
+  pending_uploads_.push_back(upload);
+  textures_.emplace(descriptor_set, texture);
+  return to_texture_id(descriptor_set);
+}
+
+void Vulkan::destroy_texture(ImTextureID texture) {
+  auto const descriptor_set = to_descriptor_set(texture);
+  std::lock_guard lock(upload_mutex_);
+  auto it = textures_.find(descriptor_set);
+  if (it == textures_.end()) [[unlikely]] { vthrow_gui_error("Destroying unknown texture"); }
+  // the frame that is recorded next may still use the texture
+  pending_destroys_.push_back({.texture = it->second, .descriptor_set = descriptor_set});
+  textures_.erase(it);
+}
+
+void Vulkan::upload_fonts(ImFontAtlas& fonts) {
+  TraceZone zone("Vulkan::upload_fonts");
+  unsigned char* pixels;
+  int width, height;
+  fonts.GetTexDataAsRGBA32(&pixels, &width, &height);
+  auto const size = 4 * static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+
+  // the previous atlas is destroyed once the frames in flight no longer use it
+  auto const previous = font_texture_;
+  font_texture_ = upload_texture({pixels, size}, width, height);
+  if (previous != nullptr) destroy_texture(previous);
+  fonts.SetTexID(font_texture_);
+}
+
+void Vulkan::new_frame() {
+  ImGui_ImplVulkan_NewFrame();
+  // newer backends create their own font atlas on the first frame, its descriptor set has the backend's layout
+  auto* fonts = ImGui::GetIO().Fonts;
+  if (font_texture_ != nullptr && fonts->TexID != font_texture_) fonts->SetTexID(font_texture_);
+}
+
+auto Vulkan::record_uploads(FrameContext& frame) -> bool {
+  std::lock_guard lock(upload_mutex_);
+  // the frame being recorded is the last one that may sample them
+  for (auto const& [texture, descriptor_set] : pending_destroys_) {
+    defer_destroy(ObjectType::descriptor_set, descriptor_set, frame_counter_ + 1);
+    defer_destroy(ObjectType::image_view, texture.view, frame_counter_ + 1);
+    defer_destroy(ObjectType::image, texture.image, frame_counter_ + 1);
+    defer_destroy(ObjectType::memory, texture.memory, frame_counter_ + 1);
+  }
+  pending_destroys_.clear();
+  if (pending_uploads_.empty()) return false;
+
+  // copies run on the transfer queue if there is one, ownership of the images is then released to the graphics queue
+  // after the copy and acquired at the start of the frame
+  bool const use_transfer_queue = transfer_queue_ != nullptr;
+  VkCommandBuffer command_buffer = frame.command_buffer;
+  VkResult err;
+  if (use_transfer_queue) {
+    command_buffer = frame.transfer_command_buffer;
+    err = vk_->vkResetCommandPool(device_, frame.transfer_command_pool, 0);
+    check_vk_result(err);
+    VkCommandBufferBeginInfo info{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VkCommandBufferUsageFlags{} | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    err = vk_->vkBeginCommandBuffer(command_buffer, &info);
+    check_vk_result(err);
+  }
+  auto const src_family = use_transfer_queue ? transfer_queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+  auto const dst_family = use_transfer_queue ? queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+
+  auto barrier = [](VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, VkAccessFlags src_access,
+                    VkAccessFlags dst_access, std::uint32_t src_queue_family = VK_QUEUE_FAMILY_IGNORED,
+                    std::uint32_t dst_queue_family = VK_QUEUE_FAMILY_IGNORED) {
+    return VkImageMemoryBarrier{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = src_access,
+        .dstAccessMask = dst_access,
+        .oldLayout = old_layout,
+        .newLayout = new_layout,
+        .srcQueueFamilyIndex = src_queue_family,
+        .dstQueueFamilyIndex = dst_queue_family,
+        .image = image,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+    };
+  };
+
+  // batch the layout transitions of all uploads around their copies
+  std::vector<VkImageMemoryBarrier> barriers;
+  barriers.reserve(pending_uploads_.size());
+  for (auto const& upload : pending_uploads_) {
+    barriers.push_back(barrier(upload.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                               VK_ACCESS_TRANSFER_WRITE_BIT));
+  }
+  vk_->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+                            nullptr, 0, nullptr, static_cast<std::uint32_t>(barriers.size()), barriers.data());
+
+  barriers.clear();
+  for (auto& upload : pending_uploads_) {
+    VkBufferImageCopy region{
+        .bufferOffset = upload.offset,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+        .imageExtent = {upload.width, upload.height, 1},
+    };
+    vk_->vkCmdCopyBufferToImage(command_buffer, upload.buffer, upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                                &region);
+    // destination access is ignored by a release
+    barriers.push_back(barrier(upload.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                               use_transfer_queue ? 0 : VK_ACCESS_SHADER_READ_BIT, src_family, dst_family));
+    upload.frame = frame_counter_;
+    recorded_uploads_.push_back(upload);
+  }
+  pending_uploads_.clear();
+  auto const dst_stage =
+      use_transfer_queue ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  vk_->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage, 0, 0, nullptr, 0, nullptr,
+                            static_cast<std::uint32_t>(barriers.size()), barriers.data());
+  if (!use_transfer_queue) return false;
+
+  err = vk_->vkEndCommandBuffer(command_buffer);
+  check_vk_result(err);
+  {
+    VkSubmitInfo info{
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &command_buffer,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &frame.transfer_complete,
+    };
+    auto queue_lock = lock_queue();
+    err = vk_->vkQueueSubmit(transfer_queue_, 1, &info, nullptr);
+    check_vk_result(err);
+  }
+
+  // matching acquire, chained to the semaphore wait of the frame submission
+  for (auto& acquire : barriers) {
+    acquire.srcAccessMask = 0;
+    acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  }
+  vk_->vkCmdPipelineBarrier(frame.command_buffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+                            static_cast<std::uint32_t>(barriers.size()), barriers.data());
+  return true;
+}
+
+void Vulkan::retire_uploads(std::uint64_t completed_frame) {
+  std::lock_guard lock(upload_mutex_);
+  while (!recorded_uploads_.empty() && recorded_uploads_.front().frame <= completed_frame) {
+    auto const& upload = recorded_uploads_.front();
+    if (upload.dedicated_memory != nullptr) {
+      vkDestroyBuffer(device_, upload.buffer, allocator_);
+      vkFreeMemory(device_, upload.dedicated_memory, allocator_);
+    } else {
+      // uploads are recorded in allocation order
+      staging_.release(upload.ring_end);
+    }
+    recorded_uploads_.pop_front();
+  }
+}
+
+template <typename Handle>
+void Vulkan::defer_destroy(ObjectType type, Handle handle, std::uint64_t frames) {
+  if (handle == nullptr) return;
+  std::lock_guard lock(deletion_mutex_);
+  deletion_queue_.push_back({.type = type, .handle = std::bit_cast<std::uint64_t>(handle), .frames = frames});
+}
+
+void Vulkan::destroy_deferred(std::uint64_t completed_frames) {
+  std::lock_guard lock(deletion_mutex_);
+  // an object released for an older frame may wait behind a newer one, that only delays it by a frame
+  while (!deletion_queue_.empty() && deletion_queue_.front().frames <= completed_frames) {
+    destroy_object(deletion_queue_.front());
+    deletion_queue_.pop_front();
+  }
+}
+
+void Vulkan::destroy_object(DeferredDestroy const& object) {
+  switch (object.type) {
+    case ObjectType::buffer:
+      vkDestroyBuffer(device_, std::bit_cast<VkBuffer>(object.handle), allocator_);
+      break;
+    case ObjectType::memory:
+      vkFreeMemory(device_, std::bit_cast<VkDeviceMemory>(object.handle), allocator_);
+      break;
+    case ObjectType::image:
+      vkDestroyImage(device_, std::bit_cast<VkImage>(object.handle), allocator_);
+      break;
+    case ObjectType::image_view:
+      vkDestroyImageView(device_, std::bit_cast<VkImageView>(object.handle), allocator_);
+      break;
+    case ObjectType::framebuffer:
+      vkDestroyFramebuffer(device_, std::bit_cast<VkFramebuffer>(object.handle), allocator_);
+      break;
+    case ObjectType::semaphore:
+      vkDestroySemaphore(device_, std::bit_cast<VkSemaphore>(object.handle), allocator_);
+      break;
+    case ObjectType::swap_chain:
+      vkDestroySwapchainKHR(device_, std::bit_cast<VkSwapchainKHR>(object.handle), allocator_);
+      break;
+    case ObjectType::descriptor_set: {
+      auto lock = lock_descriptor_pool();
+      shared_device_->descriptors_.free(std::bit_cast<VkDescriptorSet>(object.handle));
+      break;
+    }
+  }
+}
+
+void Vulkan::set_frame_capture(bool enable) noexcept { capture_all_ = enable; }
+
+void Vulkan::capture_next_frame() noexcept { capture_next_ = true; }
+
+void Vulkan::set_capture_handler(std::function<void(FrameCapture const&)> handler) {
+  capture_handler_ = std::move(handler);
+}
+
+[[nodiscard]] static auto to_pixel_format(VkFormat format) noexcept -> std::optional<PixelFormat> {
+  switch (format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+      return PixelFormat::rgba8;
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+      return PixelFormat::bgra8;
+    case VK_FORMAT_R8G8B8_UNORM:
+      return PixelFormat::rgb8;
+    case VK_FORMAT_B8G8R8_UNORM:
+      return PixelFormat::bgr8;
+    default:
+      return std::nullopt;
+  }
+}
+
+void Vulkan::record_capture(FrameContext& frame, VkImage image, VkImageLayout layout) {
+  auto const format = to_pixel_format(main_window_data_.SurfaceFormat.format);
+  if (!capture_supported_ || !format) return;
+  auto const width = static_cast<std::uint32_t>(main_window_data_.Width);
+  auto const height = static_cast<std::uint32_t>(main_window_data_.Height);
+  auto const pixel_size = *format == PixelFormat::rgba8 || *format == PixelFormat::bgra8 ? 4u : 3u;
+  auto const size = VkDeviceSize{width} * height * pixel_size;
+
+  // the previous capture of this slot has been delivered once its frame completed
+  auto& readback = frame.readback;
+  if (readback.size < size) {
+    destroy_readback(readback);
+    create_readback(readback, size);
+  }
+
+  // the end of the render pass or the upscale left the image in its final layout, the copy has to wait for the writes
+  VkImageMemoryBarrier to_transfer{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+      .oldLayout = layout,
+      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = image,
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  vk_->vkCmdPipelineBarrier(frame.command_buffer,
+                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &to_transfer);
+  VkBufferImageCopy region{
+      .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .imageExtent = {width, height, 1},
+  };
+  vk_->vkCmdCopyImageToBuffer(frame.command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1,
+                              &region);
+
+  // the copy has to be visible to the host, swap chain images go back to the layout the present expects
+  VkBufferMemoryBarrier to_host{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = readback.buffer,
+      .offset = 0,
+      .size = size,
+  };
+  VkImageMemoryBarrier to_present{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+      .dstAccessMask = 0,
+      .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      .newLayout = layout,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = image,
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  bool const transition = layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  vk_->vkCmdPipelineBarrier(frame.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VkPipelineStageFlags{VK_PIPELINE_STAGE_HOST_BIT} | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                            0, nullptr, 1, &to_host, transition ? 1u : 0u, &to_present);
+
+  readback.pending = true;
+  readback.capture = {
+      .frame = frame_counter_,
+      .width = width,
+      .height = height,
+      .format = *format,
+      .pixels = {readback.mapped, static_cast<std::size_t>(size)},
+  };
+}
+
+void Vulkan::deliver_captures() {
+  if (frames_.empty()) return;
+  auto const completed = completed_frames();
+  // the slot that is recycled next holds the oldest frame
+  for (std::size_t i = 0; i < frames_.size(); ++i) {
+    auto& readback = frames_[(frame_counter_ + i) % frames_.size()].readback;
+    if (!readback.pending || readback.capture.frame >= completed) continue;
+    readback.pending = false;
+    if (!readback.coherent) {
+      VkMappedMemoryRange range{
+          .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+          .memory = readback.memory,
+          .offset = 0,
+          .size = VK_WHOLE_SIZE,
+      };
+      auto const err = vk_->vkInvalidateMappedMemoryRanges(device_, 1, &range);
+      check_vk_result(err);
+    }
+    if (capture_handler_) capture_handler_(readback.capture);
+  }
+}
+
+void Vulkan::create_readback(Readback& readback, VkDeviceSize size) {
+  VkBufferCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .size = size,
+      .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  auto err = vkCreateBuffer(device_, &info, allocator_, &readback.buffer);
+  check_vk_result(err);
+
+  // reads from uncached memory are very slow, cached memory that isn't coherent has to be invalidated before reading
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements(device_, readback.buffer, &requirements);
+  constexpr static VkMemoryPropertyFlags cached =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+  constexpr static VkMemoryPropertyFlags coherent =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  auto memory_type = try_find_memory_type(requirements.memoryTypeBits, cached | coherent);
+  readback.coherent = memory_type.has_value();
+  if (!memory_type) memory_type = try_find_memory_type(requirements.memoryTypeBits, cached);
+  if (!memory_type) {
+    memory_type = find_memory_type(requirements.memoryTypeBits, coherent);
+    readback.coherent = true;
+  }
+  VkMemoryAllocateInfo alloc_info{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .allocationSize = requirements.size,
+      .memoryTypeIndex = *memory_type,
+  };
+  err = vkAllocateMemory(device_, &alloc_info, allocator_, &readback.memory);
+  check_vk_result(err);
+  err = vkBindBufferMemory(device_, readback.buffer, readback.memory, 0);
+  check_vk_result(err);
+  void* mapped;
+  err = vkMapMemory(device_, readback.memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+  check_vk_result(err);
+  readback.mapped = static_cast<std::byte const*>(mapped);
+  readback.size = size;
+}
+
+void Vulkan::destroy_readback(Readback& readback) {
+  vkDestroyBuffer(device_, readback.buffer, allocator_);
+  vkFreeMemory(device_, readback.memory, allocator_);
+  readback = {};
+}
+
+void Vulkan::destroy_texture_objects(Texture const& texture, VkDescriptorSet descriptor_set) {
+  {
+    auto lock = lock_descriptor_pool();
+    shared_device_->descriptors_.free(descriptor_set);
+  }
+  vkDestroyImageView(device_, texture.view, allocator_);
+  vkDestroyImage(device_, texture.image, allocator_);
+  vkFreeMemory(device_, texture.memory, allocator_);
+}
+
+void Vulkan::destroy_textures() {
+  // only called once the device is idle
+  std::lock_guard lock(upload_mutex_);
+  auto free_staging = [this](Upload const& upload) {
+    if (upload.dedicated_memory == nullptr) return;
+    vkDestroyBuffer(device_, upload.buffer, allocator_);
+    vkFreeMemory(device_, upload.dedicated_memory, allocator_);
+  };
+  std::ranges::for_each(pending_uploads_, free_staging);
+  std::ranges::for_each(recorded_uploads_, free_staging);
+  pending_uploads_.clear();
+  recorded_uploads_.clear();
+  for (auto const& texture : pending_destroys_) destroy_texture_objects(texture.texture, texture.descriptor_set);
+  for (auto const& [descriptor_set, texture] : textures_) destroy_texture_objects(texture, descriptor_set);
+  pending_destroys_.clear();
+  textures_.clear();
+  font_texture_ = nullptr;
+
+  vkDestroySampler(device_, texture_sampler_, allocator_);
+  vkDestroyBuffer(device_, staging_.buffer, allocator_);
+  vkFreeMemory(device_, staging_.memory, allocator_);
+  texture_sampler_ = nullptr;
+  staging_ = {};
+}
+
+// Cached data is only usable on the exact device and driver that produced it, validate the header before handing it to
+// the driver since some implementations do not check it themselves
+static auto is_pipeline_cache_compatible(std::span<char const> data,
+                                         VkPhysicalDeviceProperties const& properties) noexcept -> bool {
+  VkPipelineCacheHeaderVersionOne header;
+  if (data.size() < sizeof(header)) return false;
+  std::memcpy(&header, data.data(), sizeof(header));
+  return header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+         std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void Device::create_pipeline_cache(std::filesystem::path const& directory) {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device_, &properties);
+
+  // key the file by device and driver so that multiple GPUs or driver updates don't keep invalidating each other
+  std::vector<char> data;
+  if (!directory.empty()) {
+    pipeline_cache_path_ = directory / fmt::format("pipeline_cache_{:04x}_{:04x}_{:08x}.bin", properties.vendorID,
+                                                   properties.deviceID, properties.driverVersion);
+    std::ifstream file(pipeline_cache_path_, std::ios::binary | std::ios::ate);
+    if (file) {
+      data.resize(static_cast<std::size_t>(file.tellg()));
+      file.seekg(0);
+      if (!file.read(data.data(), static_cast<std::streamsize>(data.size())) ||
+          !is_pipeline_cache_compatible(data, properties)) {
+        data.clear();
+      }
+    }
+  }
+
+  VkPipelineCacheCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .initialDataSize = data.size(),
+      .pInitialData = data.data(),
+  };
+  auto err = vkCreatePipelineCache(device_, &create_info, allocator_, &pipeline_cache_);
+  if (err != VK_SUCCESS && !data.empty()) {
+    // stale or corrupt cache, start from scratch
+    create_info.initialDataSize = 0;
+    create_info.pInitialData = nullptr;
+    err = vkCreatePipelineCache(device_, &create_info, allocator_, &pipeline_cache_);
+  }
+  check_vk_result(err);
+}
+
+void Device::save_pipeline_cache() noexcept {
+  if (pipeline_cache_ == nullptr || pipeline_cache_path_.empty()) return;
+
+  // called from the destructor, a cache that can't be saved is only reported
+  try {
+    std::size_t size = 0;
+    auto err = vkGetPipelineCacheData(device_, pipeline_cache_, &size, nullptr);
+    if (err != VK_SUCCESS || size == 0) return;
+    std::vector<char> data(size);
+    err = vkGetPipelineCacheData(device_, pipeline_cache_, &size, data.data());
+    if (err != VK_SUCCESS) return;
+
+    // write to a temporary file first so that concurrently running instances never observe a partially written cache,
+    // each instance writes its own file so that they don't truncate each other's
+    std::error_code ec;
+    std::filesystem::create_directories(pipeline_cache_path_.parent_path(), ec);
+    auto tmp_path = pipeline_cache_path_;
+    tmp_path += fmt::format(".{:08x}.tmp", std::random_device{}());
+    {
+      std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+      if (!file.write(data.data(), static_cast<std::streamsize>(size))) {
+        fmt::print(stderr, "[vulkan] Failed to write pipeline cache to {}\n", tmp_path.string());
+        file.close();
+        std::filesystem::remove(tmp_path, ec);
+        return;
+      }
+    }
+    std::filesystem::rename(tmp_path, pipeline_cache_path_, ec);
+    if (ec) {
+      fmt::print(stderr, "[vulkan] Failed to save pipeline cache to {}: {}\n", pipeline_cache_path_.string(),
+                 ec.message());
+      std::filesystem::remove(tmp_path, ec);
+    }
+  } catch (std::exception const& e) {
+    fmt::print(stderr, "[vulkan] Failed to save pipeline cache: {}\n", e.what());
+  } catch (...) {}
+}
+
+void Vulkan::maybe_resize_swap_chain(int width, int height) {
+  if (!swap_chain_rebuild_) { return; }
+  TraceZone zone("Vulkan::maybe_resize_swap_chain");
+  if (width > 0 && height > 0) {
+    select_present_mode(&main_window_data_);
+    {
+      // only waits for the device to be idle if the image count changed
+      auto lock = lock_queue();
+      ImGui_ImplVulkan_SetMinImageCount(min_image_count_);
+    }
+    // frames in flight keep rendering to the old swap chain
+    if (!create_swap_chain(width, height)) return;
+    swap_chain_rebuild_ = false;
+    presented_hash_valid_ = false;
+  }
+}
+
+void Vulkan::create_framebuffers(SDL_Window* window, VkSurfaceKHR surface) {
+  // pixels rather than points, only used if the surface lets the swap chain decide its size
+  int w, h;
+  SDL_Vulkan_GetDrawableSize(window, &w, &h);
+  select_surface_format(&main_window_data_, surface);
+  main_window_data_.RenderPass =
+      create_render_pass(main_window_data_.SurfaceFormat.format, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+  // a window created minimized gets its swap chain once it has an area
+  swap_chain_rebuild_ = !create_swap_chain(w, h);
+}
+
+void Vulkan::create_surface(SDL_Window* window, VkSurfaceKHR* surface) {
+  if (SDL_Vulkan_CreateSurface(window, instance_, surface) == 0) [[unlikely]] {
+    throw_gui_error("Failed to create Vulkan surface: {}.", SDL_GetError());
+  }
+}
+
+void Vulkan::cleanup_window() {
+  // a window that failed before its first frame may still be building the pipeline for its render pass
+  if (pipeline_build_.valid()) pipeline_build_.wait();
+  if (headless_) {
+    destroy_offscreen();
+  } else {
+    wait_idle();
+    destroy_deferred(std::numeric_limits<std::uint64_t>::max());
+    destroy_swap_chain_images(swap_chain_frames_, swap_chain_semaphores_);
+    destroy_multisample_target(multisample_);
+    destroy_scaled_target();
+    vkDestroySwapchainKHR(device_, main_window_data_.Swapchain, allocator_);
+    vkDestroyRenderPass(device_, main_window_data_.RenderPass, allocator_);
+    // SDL creates the surface without allocation callbacks so it has to be destroyed without them too
+    vkDestroySurfaceKHR(instance_, main_window_data_.Surface, nullptr);
+    main_window_data_ = ImGui_ImplVulkanH_Window();
+  }
+}
+
+auto Vulkan::try_find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags properties) const
+    -> std::optional<std::uint32_t> {
+  VkPhysicalDeviceMemoryProperties memory_properties;
+  vkGetPhysicalDeviceMemoryProperties(physical_device_, &memory_properties);
+  for (std::uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+    if ((type_bits & (1u << i)) != 0 && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+auto Vulkan::find_memory_type(std::uint32_t type_bits, VkMemoryPropertyFlags properties) const -> std::uint32_t {
+  if (auto type = try_find_memory_type(type_bits, properties); type) return *type;
+  throw_gui_error("Could not find memory type with properties {:#x} in {:#b}", properties, type_bits);
+}
+
+auto Vulkan::create_render_pass(VkFormat format, VkImageLayout final_layout) const -> VkRenderPass {
+  bool const multisampled = msaa_samples_ != VK_SAMPLE_COUNT_1_BIT;
+  std::array<VkAttachmentDescription, 2> attachments{{
+      {
+          .format = format,
+          .samples = VK_SAMPLE_COUNT_1_BIT,
+          .loadOp = main_window_data_.ClearEnable ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+          .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+          .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+          .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+          .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+          .finalLayout = final_layout,
+      },
+  }};
+  if (multisampled) {
+    // the samples never leave tile memory, a transient image has no previous contents to load so it is always cleared
+    attachments[1] = attachments[0];
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].samples = msaa_samples_;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  }
+  VkAttachmentReference color_attachment{
+      .attachment = 0,
+      .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+  };
+  VkAttachmentReference resolve_attachment{
+      .attachment = 1,
+      .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+  };
+  VkSubpassDescription subpass{
+      .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+      .colorAttachmentCount = 1,
+      .pColorAttachments = &color_attachment,
+      .pResolveAttachments = multisampled ? &resolve_attachment : nullptr,
+  };
+  // images ending in transfer source are read back or blitted, those reads and writes finish before the next pass
+  bool const transfer = final_layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  VkSubpassDependency dependency{
+      .srcSubpass = VK_SUBPASS_EXTERNAL,
+      .dstSubpass = 0,
+      .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                      (transfer ? VkPipelineStageFlags{VK_PIPELINE_STAGE_TRANSFER_BIT} : VkPipelineStageFlags{0}),
+      .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      // the multisampled image is shared by all frames in flight and offscreen images are reused without a present in
+      // between, the previous frame has to be done writing to them
+      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                       (transfer ? VkAccessFlags{VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT}
+                                 : VkAccessFlags{0}),
+      .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+  };
+  VkRenderPassCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+      .attachmentCount = multisampled ? 2u : 1u,
+      .pAttachments = attachments.data(),
+      .subpassCount = 1,
+      .pSubpasses = &subpass,
+      .dependencyCount = 1,
+      .pDependencies = &dependency,
+  };
+  VkRenderPass render_pass;
+  auto err = vkCreateRenderPass(device_, &info, allocator_, &render_pass);
+  check_vk_result(err);
+  return render_pass;
+}
+
+auto Vulkan::set_msaa_samples(std::uint32_t samples) -> std::uint32_t {
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device_, &properties);
+  // the highest supported count that doesn't exceed the requested one, single sampling is always supported
+  auto count = std::bit_floor(std::clamp(samples, 1u, static_cast<std::uint32_t>(VK_SAMPLE_COUNT_64_BIT)));
+  while (count > 1 && (properties.limits.framebufferColorSampleCounts & count) == 0) count >>= 1;
+  msaa_samples_ = static_cast<VkSampleCountFlagBits>(count);
+  return count;
+}
+
+auto Vulkan::create_multisample_target(VkFormat format, VkExtent2D extent) const -> MultisampleTarget {
+  MultisampleTarget target;
+  if (msaa_samples_ == VK_SAMPLE_COUNT_1_BIT) return target;
+
+  VkImageCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .imageType = VK_IMAGE_TYPE_2D,
+      .format = format,
+      .extent = {extent.width, extent.height, 1},
+      .mipLevels = 1,
+      .arrayLayers = 1,
+      .samples = msaa_samples_,
+      .tiling = VK_IMAGE_TILING_OPTIMAL,
+      .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  auto err = vkCreateImage(device_, &info, allocator_, &target.image);
+  check_vk_result(err);
+
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements(device_, target.image, &requirements);
+  // tile based GPUs never back lazily allocated memory, desktop GPUs don't have it and need real memory
+  auto type = try_find_memory_type(requirements.memoryTypeBits,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+  if (!type) type = find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  VkMemoryAllocateInfo alloc_info{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .allocationSize = requirements.size,
+      .memoryTypeIndex = *type,
+  };
+  err = vkAllocateMemory(device_, &alloc_info, allocator_, &target.memory);
+  check_vk_result(err);
+  err = vkBindImageMemory(device_, target.image, target.memory, 0);
+  check_vk_result(err);
+
+  VkImageViewCreateInfo view_info{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .image = target.image,
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format = format,
+      .components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A},
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  err = vkCreateImageView(device_, &view_info, allocator_, &target.view);
+  check_vk_result(err);
+  return target;
+}
+
+void Vulkan::destroy_multisample_target(MultisampleTarget& target) const noexcept {
+  vkDestroyImageView(device_, target.view, allocator_);
+  vkDestroyImage(device_, target.image, allocator_);
+  vkFreeMemory(device_, target.memory, allocator_);
+  target = {};
+}
+
+auto Vulkan::create_framebuffer(VkImageView view, VkExtent2D extent) const -> VkFramebuffer {
+  std::array<VkImageView, 2> attachments{multisample_.view, view};
+  bool const multisampled = multisample_.view != nullptr;
+  VkFramebufferCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+      .renderPass = main_window_data_.RenderPass,
+      .attachmentCount = multisampled ? 2u : 1u,
+      .pAttachments = multisampled ? attachments.data() : &attachments[1],
+      .width = extent.width,
+      .height = extent.height,
+      .layers = 1,
+  };
+  VkFramebuffer framebuffer;
+  auto err = vkCreateFramebuffer(device_, &info, allocator_, &framebuffer);
+  check_vk_result(err);
+  return framebuffer;
+}
+
+void Vulkan::create_offscreen(int width, int height, std::uint32_t image_count) {
+  if (!headless_) [[unlikely]] { vthrow_gui_error("Offscreen render targets require a headless Vulkan instance"); }
+  if (width <= 0 || height <= 0 || image_count == 0) [[unlikely]] {
+    throw_gui_error("Invalid offscreen render target {}x{} with {} images", width, height, image_count);
+  }
+
+  // handles start out null and destroying them is a no-op, a partially created target is released as a whole
+  try {
+    auto* wd = &main_window_data_;
+    wd->Width = width;
+    wd->Height = height;
+    wd->SurfaceFormat = {VK_FORMAT_R8G8B8A8_UNORM, VK_COLORSPACE_SRGB_NONLINEAR_KHR};
+    wd->ImageCount = image_count;
+    // images are left ready for readback
+    capture_supported_ = true;
+    check_render_scale_support(wd->SurfaceFormat.format, VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    wd->RenderPass = create_render_pass(wd->SurfaceFormat.format, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    // mimic swap chain frames so that the rest of the rendering code can stay the same
+    offscreen_images_.resize(image_count);
+    offscreen_frames_.resize(image_count);
+    wd->Frames = offscreen_frames_.data();
+    VkExtent2D const extent{static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height)};
+    multisample_ = create_multisample_target(wd->SurfaceFormat.format, extent);
+
+    VkResult err;
+    for (std::uint32_t i = 0; i < image_count; ++i) {
+      auto& target = offscreen_images_[i];
+      auto& fd = offscreen_frames_[i];
+      {
+        VkImageCreateInfo info{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = wd->SurfaceFormat.format,
+            .extent = {static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height), 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                     VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        };
+        err = vkCreateImage(device_, &info, allocator_, &target.image);
+        check_vk_result(err);
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device_, target.image, &requirements);
+        VkMemoryAllocateInfo alloc_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .allocationSize = requirements.size,
+            .memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+        };
+        err = vkAllocateMemory(device_, &alloc_info, allocator_, &target.memory);
+        check_vk_result(err);
+        err = vkBindImageMemory(device_, target.image, target.memory, 0);
+        check_vk_result(err);
+        fd.Backbuffer = target.image;
+      }
+      {
+        VkImageViewCreateInfo info{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = target.image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = wd->SurfaceFormat.format,
+            .components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B,
+                           VK_COMPONENT_SWIZZLE_A},
+            .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+        };
+        err = vkCreateImageView(device_, &info, allocator_, &fd.BackbufferView);
+        check_vk_result(err);
+      }
+      fd.Framebuffer = create_framebuffer(fd.BackbufferView, extent);
+    }
+  } catch (...) {
+    destroy_offscreen();
+    throw;
+  }
+}
+
+void Vulkan::destroy_offscreen() {
+  wait_idle();
+  for (auto& fd : offscreen_frames_) {
+    vkDestroyFramebuffer(device_, fd.Framebuffer, allocator_);
+    vkDestroyImageView(device_, fd.BackbufferView, allocator_);
+  }
+  for (auto& target : offscreen_images_) {
+    vkDestroyImage(device_, target.image, allocator_);
+    vkFreeMemory(device_, target.memory, allocator_);
+  }
+  destroy_multisample_target(multisample_);
+  destroy_scaled_target();
+  vkDestroyRenderPass(device_, main_window_data_.RenderPass, allocator_);
+  offscreen_frames_.clear();
+  offscreen_images_.clear();
+  main_window_data_ = ImGui_ImplVulkanH_Window();
+}
+
+void Vulkan::check_render_scale_support(VkFormat format, VkImageUsageFlags supported_usage) {
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties(physical_device_, format, &properties);
+  auto const features = properties.optimalTilingFeatures;
+  constexpr static VkFormatFeatureFlags blit = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+  render_scale_supported_ = (supported_usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0 && (features & blit) == blit;
+  upscale_filter_ = (features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0 ? VK_FILTER_LINEAR
+                                                                                          : VK_FILTER_NEAREST;
+}
+
+void Vulkan::create_scaled_target(VkExtent2D extent) {
+  auto const format = main_window_data_.SurfaceFormat.format;
+  // the clear and multisampling settings don't change after the window is created
+  if (scaled_render_pass_ == nullptr) {
+    scaled_render_pass_ = create_render_pass(format, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+  }
+
+  VkImageCreateInfo info{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .imageType = VK_IMAGE_TYPE_2D,
+      .format = format,
+      .extent = {extent.width, extent.height, 1},
+      .mipLevels = 1,
+      .arrayLayers = 1,
+      .samples = VK_SAMPLE_COUNT_1_BIT,
+      .tiling = VK_IMAGE_TILING_OPTIMAL,
+      .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  auto err = vkCreateImage(device_, &info, allocator_, &scaled_.image);
+  check_vk_result(err);
+
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements(device_, scaled_.image, &requirements);
+  VkMemoryAllocateInfo alloc_info{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .allocationSize = requirements.size,
+      .memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+  };
+  err = vkAllocateMemory(device_, &alloc_info, allocator_, &scaled_.memory);
+  check_vk_result(err);
+  err = vkBindImageMemory(device_, scaled_.image, scaled_.memory, 0);
+  check_vk_result(err);
+
+  VkImageViewCreateInfo view_info{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .image = scaled_.image,
+      .viewType = VK_IMAGE_VIEW_TYPE_2D,
+      .format = format,
+      .components = {VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A},
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  err = vkCreateImageView(device_, &view_info, allocator_, &scaled_.view);
+  check_vk_result(err);
+  // render pass compatibility only looks at the attachments, the main window framebuffers are created the same way
+  scaled_.framebuffer = create_framebuffer(scaled_.view, extent);
+}
+
+void Vulkan::destroy_scaled_target() noexcept {
+  vkDestroyFramebuffer(device_, scaled_.framebuffer, allocator_);
+  vkDestroyImageView(device_, scaled_.view, allocator_);
+  vkDestroyImage(device_, scaled_.image, allocator_);
+  vkFreeMemory(device_, scaled_.memory, allocator_);
+  scaled_ = {};
+  vkDestroyRenderPass(device_, scaled_render_pass_, allocator_);
+  scaled_render_pass_ = nullptr;
+}
+
+void Vulkan::record_upscale(VkCommandBuffer command_buffer, VkImage image, VkExtent2D source, VkExtent2D extent,
+                            VkImageLayout layout) {
+  // the render pass left the scaled image ready for the blit but its writes still have to be made visible to it, the
+  // main window image is overwritten completely
+  std::array<VkImageMemoryBarrier, 2> to_transfer{{
+      {
+          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+          .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+          .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+          .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image = scaled_.image,
+          .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+      },
+      {
+          .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+          .srcAccessMask = 0,
+          .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+          .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+          .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+          .image = image,
+          .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+      },
+  }};
+  // the transfer stage is the one the image acquisition is waited for in
+  vk_->vkCmdPipelineBarrier(command_buffer,
+                            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+                            static_cast<std::uint32_t>(to_transfer.size()), to_transfer.data());
+
+  VkImageBlit region{
+      .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .srcOffsets = {{}, {static_cast<std::int32_t>(source.width), static_cast<std::int32_t>(source.height), 1}},
+      .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .dstOffsets = {{}, {static_cast<std::int32_t>(extent.width), static_cast<std::int32_t>(extent.height), 1}},
+  };
+  vk_->vkCmdBlitImage(command_buffer, scaled_.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, upscale_filter_);
+
+  // same layout the render pass would have left the image in, present and capture synchronize with the transfer
+  VkImageMemoryBarrier to_final{
+      .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = 0,
+      .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      .newLayout = layout,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = image,
+      .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+  };
+  vk_->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                            nullptr, 0, nullptr, 1, &to_final);
+}
+
+static auto resolve_pipeline_cache_directory(std::filesystem::path const& directory, std::string const& name)
+    -> std::filesystem::path {
+  if (!directory.empty()) return directory;
+  std::filesystem::path pref_directory;
+  if (char* pref_path = SDL_GetPrefPath("imgui_vulkan", name.c_str()); pref_path != nullptr) {
+    pref_directory = pref_path;
+    SDL_free(pref_path);
+  }
+  return pref_directory;
+}
+
+static auto create_imgui_context(std::uint32_t msaa_samples, ImFontAtlas* fonts) -> ImGuiContext* {
+  IMGUI_CHECKVERSION();
+  // every window has its own context, creating one doesn't make it current if there already is one. The atlas is owned
+  // by the window so that it can be replaced by the one built during startup
+  ImGuiContext* context = ImGui::CreateContext(fonts);
+  ImGui::SetCurrentContext(context);
+  ImGuiIO& io [[maybe_unused]] = ImGui::GetIO();
+  // io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+  // io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+
+  // Setup Dear ImGui style
+  ImGui::StyleColorsDark();
+  // ImGui::StyleColorsClassic();
+  if (msaa_samples > 1) {
+    // multisampling smooths the edges, feathered outlines would only add vertices
+    auto& style = ImGui::GetStyle();
+    style.AntiAliasedLines = false;
+    style.AntiAliasedFill = false;
+  }
+  return context;
+}
+
+// whether the SDL window belongs to a viewport of the current ImGui context
+static auto is_viewport_window([[maybe_unused]] std::uint32_t window_id) noexcept -> bool {
+#ifdef IMGUI_HAS_VIEWPORT
+  auto* window = SDL_GetWindowFromID(window_id);
+  return window != nullptr && ImGui::FindViewportByPlatformHandle(window) != nullptr;
+#else
+  return false;
+#endif
+}
+
+// SDL window an event is addressed to, 0 for events that concern all windows
+static auto event_window_id(SDL_Event const& event) noexcept -> std::uint32_t {
+  switch (event.type) {
+    case SDL_WINDOWEVENT: return event.window.windowID;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: return event.key.windowID;
+    case SDL_TEXTEDITING: return event.edit.windowID;
+    case SDL_TEXTINPUT: return event.text.windowID;
+    case SDL_MOUSEMOTION: return event.motion.windowID;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP: return event.button.windowID;
+    case SDL_MOUSEWHEEL: return event.wheel.windowID;
+    case SDL_DROPFILE:
+    case SDL_DROPTEXT:
+    case SDL_DROPBEGIN:
+    case SDL_DROPCOMPLETE: return event.drop.windowID;
+    default: return 0;
+  }
+}
+
+[[nodiscard]] static auto is_input_event(SDL_Event const& event) noexcept -> bool {
+  switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    case SDL_TEXTEDITING:
+    case SDL_TEXTINPUT:
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    case SDL_MOUSEWHEEL: return true;
+    default: return false;
+  }
+}
+
+// only called once the frame has been presented
+static void record_input_latency(FrameTimings& timings,
+                                 std::optional<std::chrono::steady_clock::time_point> const& input_time) {
+  if (!input_time) return;
+  timings.input_latency =
+      std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - *input_time).count();
+}
+
+Window::Window(std::string name, int width, int height) noexcept
+    : name_(std::move(name)), size_({width, height}), present_policy_{.mode = build_config.present_mode} {}
+
+Window::~Window() noexcept = default;
+
+// milliseconds since the previous step, which ends now
+static auto startup_step(std::chrono::steady_clock::time_point& last) noexcept -> float {
+  auto const now = std::chrono::steady_clock::now();
+  auto const milliseconds = std::chrono::duration<float, std::milli>(now - last).count();
+  last = now;
+  return milliseconds;
+}
+
+// ImGui's current context is one global unless imconfig.h redirects `GImGui`, to a thread_local as ImGui suggests for
+// contexts used on several threads
+#ifdef GImGui
+constexpr static bool thread_local_imgui_context = true;
+#else
+constexpr static bool thread_local_imgui_context = false;
+#endif
+// windows with an ImGui context and the one rendering on its own thread, only used on the UI thread. With more than one
+// window the UI thread and a render thread would switch the global current context under each other
+static std::vector<Window const*> shown_windows;
+static Window* threaded_window = nullptr;
+
+void Window::create(std::shared_ptr<Device>& device) {
+  TraceZone zone("Window::create");
+  if (!thread_local_imgui_context && threaded_window != nullptr) threaded_window->stop_render_thread();
+  shown_windows.push_back(this);
+  reset_startup_timings();
+  auto last = startup_begin_;
+
+  // Setup window
+  constexpr static SDL_WindowFlags window_flags =
+      (SDL_WindowFlags)(SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
+  window_ =
+      SDL_CreateWindow(name_.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size_[0], size_[1], window_flags);
+  if (window_ == nullptr) [[unlikely]] {
+    throw_gui_error("Failed to create SDL window for '{}': {}", name_, SDL_GetError());
+  }
+  startup_.window = startup_step(last);
+
+  // Setup Vulkan, the first window creates the device shared by all others
+  if (device == nullptr) {
+    uint32_t extensions_count = 0;
+    SDL_Vulkan_GetInstanceExtensions(window_, &extensions_count, nullptr);
+    std::vector<char const*> extensions(extensions_count);
+    SDL_Vulkan_GetInstanceExtensions(window_, &extensions_count, extensions.data());
+    auto const* callbacks = make_allocation_callbacks();
+    device = std::make_shared<Device>(extensions, window_, callbacks, host_allocator_, gpu_selection_);
+
+    // Load pipeline cache from previous runs
+    device->create_pipeline_cache(resolve_pipeline_cache_directory(pipeline_cache_directory_, name_));
+  }
+  vulkan_ = std::make_unique<Vulkan>(device);
+  device_info_ = vulkan_->device_info();
+  startup_.device = startup_step(last);
+
+  // Create Window Surface
+  VkSurfaceKHR surface;
+  vulkan_->create_surface(window_, &surface);
+
+  // Create Framebuffers
+  vulkan_->set_present_mode(present_policy_.mode);
+  vulkan_->set_render_scale_policy(render_scale_policy_);
+  msaa_samples_ = vulkan_->set_msaa_samples(msaa_samples_);
+  vulkan_->create_framebuffers(window_, surface);
+  vulkan_->build_pipeline(startup_pipeline_);
+  vulkan_->create_frame_contexts(frames_in_flight_);
+  vulkan_->create_staging_ring(staging_buffer_size_);
+  vulkan_->create_geometry_ring(device_local_geometry_);
+  vulkan_->set_parallel_recording(parallel_recording_);
+  vulkan_->set_frame_capture(frame_capture_);
+  vulkan_->set_capture_handler([this](FrameCapture const& capture) { on_frame_captured(capture); });
+  startup_.swap_chain = startup_step(last);
+  // rasterized while the pipeline is built
+  build_fonts();
+
+  // Setup Dear ImGui context
+  auto* context = create_imgui_context(msaa_samples_, fonts_.get());
+#ifdef IMGUI_HAS_VIEWPORT
+  // the backends install their viewport support on init, the render thread only knows about the main viewport
+  if (multi_viewports_ && !threaded_rendering_) ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+#endif
+
+  // Setup Platform/Renderer backends
+  vulkan_->init(window_);
+  imgui_context_ = context;
+  startup_.imgui = startup_step(last);
+  vulkan_->upload_fonts(*fonts_);
+
+  running_ = true;
+  // draw the first frame right away
+  idle_deadline_ = {};
+  start_render_thread();
+}
+
+void Window::destroy() {
+  running_ = false;
+  stop_render_thread();
+  std::erase(shown_windows, this);
+  if (imgui_context_ != nullptr) {
+    ImGui::SetCurrentContext(imgui_context_);
+    vulkan_->shutdown();
+    ImGui_ImplSDL2_Shutdown();
+    ImGui::DestroyContext(imgui_context_);
+    imgui_context_ = nullptr;
+  }
+  fonts_ = nullptr;
+  if (vulkan_ != nullptr) {
+    vulkan_->cleanup_window();
+    vulkan_->cleanup();
+    vulkan_ = nullptr;
+  }
+  if (window_ != nullptr) {
+    SDL_DestroyWindow(window_);
+    window_ = nullptr;
+  }
+}
+
+auto Window::run_headless(HeadlessOptions const& options) -> HeadlessReport {
+  if (vulkan_ != nullptr) [[unlikely]] { throw_gui_error("Window '{}' is already running", name_); }
+  if (!thread_local_imgui_context && threaded_window != nullptr) threaded_window->stop_render_thread();
+  shown_windows.push_back(this);
+  scope_guard shown_guard([this]() { std::erase(shown_windows, this); });
+  reset_startup_timings();
+  auto last = startup_begin_;
+
+  // Setup Vulkan without any presentation support, the device is not shared with any other window
+  {
+    auto const* callbacks = make_allocation_callbacks();
+    auto device = std::make_shared<Device>(std::span<char const* const>{}, nullptr, callbacks, host_allocator_,
+                                           gpu_selection_);
+    device->create_pipeline_cache(resolve_pipeline_cache_directory(pipeline_cache_directory_, name_));
+    vulkan_ = std::make_unique<Vulkan>(std::move(device));
+    device_info_ = vulkan_->device_info();
+  }
+  // everything is released on return and on failures while starting up, the cleanup handles partially created state
+  bool backend_initialized = false;
+  scope_guard guard([this, &backend_initialized]() {
+    running_ = false;
+    stop_render_thread();
+    if (imgui_context_ != nullptr) {
+      if (backend_initialized) vulkan_->shutdown();
+      ImGui::DestroyContext(imgui_context_);
+      imgui_context_ = nullptr;
+    }
+    fonts_ = nullptr;
+    vulkan_->cleanup_window();
+    vulkan_->cleanup();
+    vulkan_ = nullptr;
+  });
+  startup_.device = startup_step(last);
+  msaa_samples_ = vulkan_->set_msaa_samples(msaa_samples_);
+  vulkan_->set_render_scale_policy(render_scale_policy_);
+  // a frame in flight must never render into an image another one is still using
+  vulkan_->create_offscreen(options.width > 0 ? options.width : size_[0],
+                            options.height > 0 ? options.height : size_[1],
+                            std::max(options.image_count, frames_in_flight_));
+  vulkan_->build_pipeline(startup_pipeline_);
+  vulkan_->create_frame_contexts(frames_in_flight_);
+  vulkan_->create_staging_ring(staging_buffer_size_);
+  vulkan_->create_geometry_ring(device_local_geometry_);
+  vulkan_->set_parallel_recording(parallel_recording_);
+  vulkan_->set_frame_capture(frame_capture_);
+  vulkan_->set_capture_handler([this](FrameCapture const& capture) { on_frame_captured(capture); });
+  startup_.swap_chain = startup_step(last);
+  build_fonts();
+
+  imgui_context_ = create_imgui_context(msaa_samples_, fonts_.get());
+  // don't let saved window layouts affect reproducibility
+  ImGui::GetIO().IniFilename = nullptr;
+  vulkan_->init(nullptr);
+  backend_initialized = true;
+  startup_.imgui = startup_step(last);
+  vulkan_->upload_fonts(*fonts_);
+
+  running_ = true;
+
+  start_render_thread();
+  auto const first_frame = frame_count_;
+  auto const start = std::chrono::steady_clock::now();
+  for (std::uint64_t frame = 0; frame < options.frames && running_; ++frame) { draw_headless(options, frame); }
+  // include the GPU work of the last frames
+  if (render_thread_ != nullptr) render_thread_->flush();
+  vulkan_->wait_idle();
+  vulkan_->deliver_captures();
+  auto const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  HeadlessReport report{
+      .frames = frame_count_ - first_frame,
+      .seconds = seconds,
+  };
+  report.fps = seconds > 0 ? static_cast<double>(report.frames) / seconds : 0;
+  report.stats = frame_stats(static_cast<std::size_t>(report.frames));
+  report.descriptors = descriptor_stats();
+  return report;
+}
+
+void Window::draw_headless(HeadlessOptions const& options, std::uint64_t frame) {
+  TraceZone zone("Window::draw_headless");
+  FrameTimings timings{.frame = frame_count_};
+  PhaseTimer timer(timings);
+
+  auto const& wd = vulkan_->main_window_data();
+  ImGuiIO& io = ImGui::GetIO();
+  io.DisplaySize = ImVec2(static_cast<float>(wd.Width), static_cast<float>(wd.Height));
+  io.DeltaTime = options.delta_time;
+  if (options.synthetic_input) { on_synthetic_input(io, frame); }
+  timer.mark(FramePhase::poll_events);
+
+  vulkan_->new_frame();
+  draw_frame(timer);
+}
+
+void Window::on_load_fonts(ImFontAtlas& fonts [[maybe_unused]]) {
+  // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use
+  // ImGui::PushFont()/PopFont() to select them.
+  // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
+  // - If the file cannot be loaded, the function will return NULL. Please handle those errors in your application (e.g.
+  // use an assertion, or display an error and quit).
+  // - The fonts will be rasterized at a given size (w/ oversampling) and stored into a texture when calling
+  // ImFontAtlas::Build()/GetTexDataAsXXXX(), which `load_fonts()` calls.
+  // - Read 'docs/FONTS.md' for more instructions and details.
+  // - Remember that in C/C++ if you want to include a backslash \ in a string literal you need to write a double
+  // backslash \\ !
+  // fonts.AddFontDefault();
+  // fonts.AddFontFromFileTTF("../../misc/fonts/Roboto-Medium.ttf", 16.0f);
+  // fonts.AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
+  // fonts.AddFontFromFileTTF("../../misc/fonts/DroidSans.ttf", 16.0f);
+  // fonts.AddFontFromFileTTF("../../misc/fonts/ProggyTiny.ttf", 10.0f);
+  // ImFont* font = fonts.AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL,
+  // fonts.GetGlyphRangesJapanese()); IM_ASSERT(font != NULL);
+}
+
+void Window::load_fonts() {
+  fonts_dirty_ = false;
+  ImFontAtlas& fonts = *ImGui::GetIO().Fonts;
+  fonts.Clear();
+  on_load_fonts(fonts);
+  // copied to the GPU with the next frame
+  vulkan_->upload_fonts(fonts);
+}
+
+void Window::reset_startup_timings() noexcept {
+  startup_ = {};
+  startup_pipeline_ = 0;
+  startup_first_frame_ = 0;
+  startup_begin_ = std::chrono::steady_clock::now();
+}
+
+void Window::build_fonts() {
+  TraceZone zone("Window::on_load_fonts");
+  auto const start = std::chrono::steady_clock::now();
+  // requests from before the window was shown are covered by this build
+  fonts_dirty_ = false;
+  // ImFontAtlas allocates through ImGui::MemAlloc, which counts the allocations in the current context, so it can only
+  // be built on the thread that owns the contexts
+  fonts_ = std::make_unique<ImFontAtlas>();
+  on_load_fonts(*fonts_);
+  // rasterizes the atlas, the upload only copies the cached pixels
+  unsigned char* pixels;
+  int width, height;
+  fonts_->GetTexDataAsRGBA32(&pixels, &width, &height);
+  startup_.fonts = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+auto Window::startup_timings() const noexcept -> StartupTimings {
+  auto timings = startup_;
+  timings.pipeline = startup_pipeline_.load(std::memory_order_relaxed);
+  timings.first_frame = startup_first_frame_.load(std::memory_order_relaxed);
+  return timings;
+}
+
+auto Window::upload_texture(std::span<std::uint8_t const> rgba, int width, int height) -> ImTextureID {
+  if (vulkan_ == nullptr) [[unlikely]] { throw_gui_error("Window '{}' is not shown", name_); }
+  return vulkan_->upload_texture(rgba, width, height);
+}
+
+void Window::destroy_texture(ImTextureID texture) {
+  if (vulkan_ == nullptr) [[unlikely]] { throw_gui_error("Window '{}' is not shown", name_); }
+  vulkan_->destroy_texture(texture);
+}
+
+void Window::on_synthetic_input(ImGuiIO& io, std::uint64_t frame) {
+  // sweep the mouse over the whole display in a deterministic Lissajous pattern
+  auto const t = static_cast<float>(frame) * io.DeltaTime;
+  io.AddMousePosEvent((0.5f + 0.5f * std::sin(3.0f * t)) * io.DisplaySize.x,
+                      (0.5f + 0.5f * std::sin(2.0f * t)) * io.DisplaySize.y);
+}
+
+void Window::request_redraw() noexcept {
+  redraw_requested_ = true;
+  // wake up the event loop if it is waiting, pushing events is thread safe in SDL
+  SDL_Event event{};
+  event.type = SDL_USEREVENT;
+  SDL_PushEvent(&event);
+}
+
+void Window::set_present_policy(PresentPolicy policy) {
+  present_policy_ = policy;
+  next_frame_time_ = {};
+  // the render thread picks the mode up from the next frame
+  if (vulkan_ != nullptr && render_thread_ == nullptr) vulkan_->set_present_mode(policy.mode);
+}
+
+void Window::set_render_scale_policy(RenderScalePolicy const& policy) {
+  render_scale_policy_ = policy;
+  // the render thread picks the policy up from the next frame
+  if (vulkan_ != nullptr && render_thread_ == nullptr) vulkan_->set_render_scale_policy(policy);
+}
+
+auto Window::render_scale() const noexcept -> float {
+  std::array<FrameTimings, 1> latest;
+  return frame_timings_.copy_latest(latest) > 0 ? latest[0].render_scale : 1.0f;
+}
+
+void Window::before_render_frame(ImGui_ImplVulkanH_Window* wd [[maybe_unused]],
+                                 ImDrawData* draw_data [[maybe_unused]]) {}
+
+void Window::on_frame_captured(FrameCapture const& capture [[maybe_unused]]) {}
+
+void Window::set_frame_capture(bool enable) noexcept {
+  frame_capture_ = enable;
+  if (vulkan_ != nullptr) vulkan_->set_frame_capture(enable);
+}
+
+void Window::capture_next_frame() noexcept {
+  if (vulkan_ != nullptr) vulkan_->capture_next_frame();
+}
+
+void Window::wait_for_frame() {
+  frame_wait_ = 0;
+  // the render thread owns the frames in flight when threaded
+  if (!running_ || !present_policy_.low_latency || render_thread_ != nullptr) { return; }
+  if constexpr (!build_config.instrumentation) {
+    vulkan_->wait_for_frame();
+    return;
+  }
+  auto const start = std::chrono::steady_clock::now();
+  vulkan_->wait_for_frame();
+  frame_wait_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Window::draw(std::span<SDL_Event const> events) {
+  if (!running_) { return; }
+  TraceZone zone("Window::draw");
+  FrameTimings timings{.frame = frame_count_};
+  // the wait happened before the events were polled, it is part of the frame nonetheless
+  timings.cpu[static_cast<std::size_t>(FramePhase::fence_wait)] = frame_wait_;
+  timings.cpu_total = frame_wait_;
+  frame_wait_ = 0;
+  PhaseTimer timer(timings);
+  ImGui::SetCurrentContext(imgui_context_);
+
+  // Handle events (inputs, window resize, etc.) polled by the application
+  // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
+  // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite
+  // your copy of the mouse data.
+  // - When io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application, or
+  // clear/overwrite your copy of the keyboard data. Generally you may always pass all inputs to dear imgui, and hide
+  // them from your application based on those two flags.
+  auto const window_id = SDL_GetWindowID(window_);
+  // SDL timestamps are SDL_GetTicks milliseconds, the age of an event is turned into a steady clock time point
+  Uint32 ticks = 0;
+  std::chrono::steady_clock::time_point poll_time;
+  if constexpr (build_config.instrumentation) {
+    ticks = SDL_GetTicks();
+    poll_time = std::chrono::steady_clock::now();
+  }
+  bool has_event = false;
+  for (auto const& event : events) {
+    // redraw requests only wake the event loop up, `redraw_requested_` tells which window it was for
+    if (event.type == SDL_USEREVENT) { continue; }
+    auto const id = event_window_id(event);
+    if (id != 0 && id != window_id && !is_viewport_window(id)) { continue; }
+
+    ImGui_ImplSDL2_ProcessEvent(&event);
+    if constexpr (build_config.instrumentation) {
+      if (!input_time_ && is_input_event(event)) {
+        input_time_ = poll_time - std::chrono::milliseconds(ticks - event.common.timestamp);
+      }
+    }
+    // closing a viewport window only closes the ImGui windows in it
+    running_ = event.type != SDL_QUIT &&
+               !(event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && id == window_id);
+    if (!running_) { return; }
+    has_event = true;
+  }
+  if (has_event) { frames_to_render_ = idle_frames_; }
+
+  // CPU frame limiter, the application sleeps until the earliest deadline of all windows
+  auto const now = std::chrono::steady_clock::now();
+  if (now < next_frame_time_) { return; }
+  // Nothing has changed since the last frames settled, wait for the next event or idle refresh
+  if (power_saving_ && frames_to_render_ <= 0 && now < idle_deadline_ && !redraw_requested_.exchange(false)) {
+    return;
+  }
+  if (frames_to_render_ > 0) { --frames_to_render_; }
+  idle_deadline_ = std::chrono::steady_clock::time_point::max();
+  if (max_idle_fps_ > 0) {
+    idle_deadline_ = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                               std::chrono::duration<double>(1.0 / static_cast<double>(max_idle_fps_)));
+  }
+  timer.mark(FramePhase::poll_events);
+
+  // Resize swap chain? Done by the render thread when threaded
+  if (render_thread_ == nullptr) {
+    int width, height;
+    SDL_Vulkan_GetDrawableSize(window_, &width, &height);
+    vulkan_->maybe_resize_swap_chain(width, height);
+  }
+
+  // Start the Dear ImGui frame
+  vulkan_->new_frame();
+  ImGui_ImplSDL2_NewFrame();
+  draw_frame(timer);
+  if (!running_) { return; }
+
+  if (present_policy_.target_fps > 0) {
+    auto const frame_time = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / static_cast<double>(present_policy_.target_fps)));
+    // don't try to catch up if we fell behind
+    next_frame_time_ = std::max(next_frame_time_ + frame_time, std::chrono::steady_clock::now());
+  } else if (frame_skipped_.exchange(false, std::memory_order_relaxed)) {
+    // an unchanged frame neither presents nor blocks on the swap chain, wait for as long as the display would have
+    SDL_DisplayMode mode;
+    int const refresh_rate = SDL_GetWindowDisplayMode(window_, &mode) == 0 && mode.refresh_rate > 0
+                                 ? mode.refresh_rate
+                                 : 60;
+    next_frame_time_ = std::chrono::steady_clock::now() +
+                       std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(1.0 / static_cast<double>(refresh_rate)));
+  }
+}
+
+auto Window::is_idle() const noexcept -> bool {
+  return power_saving_ && frames_to_render_ <= 0 && !redraw_requested_.load();
+}
+
+auto Window::next_draw_time() const noexcept -> std::chrono::steady_clock::time_point {
+  return is_idle() ? std::max(idle_deadline_, next_frame_time_) : next_frame_time_;
+}
+
+void Window::draw_frame(PhaseTimer& timer) {
+  // the atlas can't be changed during a frame
+  if (fonts_dirty_) { load_fonts(); }
+  ImGui::NewFrame();
+  timer.mark(FramePhase::new_frame);
+
+  {
+    TraceZone zone("on_gui");
+    on_gui();
+  }
+  if (!running_) { return; }
+  if (stats_overlay_) { draw_stats_overlay(); }
+  timer.mark(FramePhase::on_gui);
+
+  // Rendering
+  ImGui::Render();
+  ImDrawData* draw_data = ImGui::GetDrawData();
+  // viewport windows are drawn in the same submission as the main window
+  vulkan_->update_viewports();
+  timer.mark(FramePhase::render);
+  const bool is_minimized = (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f);
+  // input of minimized or unchanged frames never reaches the screen
+  auto const input_time = std::exchange(input_time_, std::nullopt);
+  if (!is_minimized && render_thread_ != nullptr) {
+    // the rest of the frame is timed and recorded by the render thread
+    FrameSnapshot& snapshot = render_thread_->acquire();
+    snapshot.copy(*draw_data);
+    if (window_ != nullptr) SDL_Vulkan_GetDrawableSize(window_, &snapshot.size[0], &snapshot.size[1]);
+    snapshot.present_mode = present_policy_.mode;
+    snapshot.render_scale = render_scale_policy_;
+    snapshot.skip_unchanged = skip_unchanged_frames_;
+    snapshot.input_time = input_time;
+    timer.mark(FramePhase::snapshot);
+    timer.finish();
+    snapshot.timings = timer.timings();
+    render_thread_->publish(snapshot);
+    ++frame_count_;
+    return;
+  }
+  if (render_thread_ != nullptr) {
+    // the render thread is the only one ending frames while it exists and may still be ending the last snapshot,
+    // minimized frames are not recorded then
+    ++frame_count_;
+    return;
+  }
+  if (!is_minimized) [[likely]] {
+    auto* wd = &vulkan_->main_window_data();
+    before_render_frame(wd, draw_data);
+    timer.mark(FramePhase::before_render_frame);
+    if (skip_unchanged_frames_ && vulkan_->frame_unchanged(wd, draw_data)) {
+      ++skipped_frames_;
+      frame_skipped_.store(true, std::memory_order_relaxed);
+    } else {
+      vulkan_->render_frame(wd, draw_data, timer);
+      vulkan_->present_frame(wd, timer);
+      if constexpr (build_config.instrumentation) record_input_latency(timer.timings(), input_time);
+    }
+  }
+
+  timer.finish();
+  end_frame(timer.timings());
+  ++frame_count_;
+}
+
+void Window::start_render_thread() {
+  if (!build_config.threaded_rendering || !threaded_rendering_) return;
+  if (!thread_local_imgui_context && (shown_windows.size() > 1 || threaded_window != nullptr)) return;
+  threaded_window = this;
+  render_thread_ = std::make_unique<RenderThread>([this](FrameSnapshot& snapshot) {
+    TraceZone zone("render thread frame");
+    PhaseTimer timer(snapshot.timings);
+    // the Vulkan backend looks its state up through the current context
+    ImGui::SetCurrentContext(imgui_context_);
+    vulkan_->set_present_mode(snapshot.present_mode);
+    vulkan_->set_render_scale_policy(snapshot.render_scale);
+    vulkan_->maybe_resize_swap_chain(snapshot.size[0], snapshot.size[1]);
+    timer.mark(FramePhase::new_frame);
+
+    auto* wd = &vulkan_->main_window_data();
+    before_render_frame(wd, &snapshot.draw_data);
+    timer.mark(FramePhase::before_render_frame);
+    if (snapshot.skip_unchanged && vulkan_->frame_unchanged(wd, &snapshot.draw_data)) {
+      ++skipped_frames_;
+      frame_skipped_.store(true, std::memory_order_relaxed);
+    } else {
+      vulkan_->render_frame(wd, &snapshot.draw_data, timer);
+      vulkan_->present_frame(wd, timer);
+      if constexpr (build_config.instrumentation) record_input_latency(snapshot.timings, snapshot.input_time);
+    }
+
+    timer.finish();
+    end_frame(snapshot.timings);
+  });
+}
+
+void Window::stop_render_thread() noexcept {
+  // hands the frames in flight back to the UI thread
+  render_thread_ = nullptr;
+  if (threaded_window == this) threaded_window = nullptr;
+}
+
+auto Window::make_allocation_callbacks() -> VkAllocationCallbacks const* {
+  if (allocation_callbacks_ != nullptr) return allocation_callbacks_;
+  if (!host_allocator_options_.enable) return nullptr;
+  if (host_allocator_ == nullptr) host_allocator_ = std::make_shared<HostAllocator>(host_allocator_options_);
+  return host_allocator_->callbacks();
+}
+
+void Window::end_frame(FrameTimings const& timings) {
+  // called by the render thread while there is one and by the UI thread otherwise, never by both
+  if (startup_first_frame_.load(std::memory_order_relaxed) == 0) {
+    auto const elapsed = std::chrono::steady_clock::now() - startup_begin_;
+    startup_first_frame_.store(std::chrono::duration<float, std::milli>(elapsed).count(), std::memory_order_relaxed);
+  }
+  frame_timings_.push(timings);
+  if (host_allocator_ != nullptr) host_allocator_->end_frame();
+}
+
+auto Window::host_memory_stats() const noexcept -> HostMemoryStats {
+  return host_allocator_ != nullptr ? host_allocator_->stats() : HostMemoryStats{};
+}
+
+auto Window::descriptor_stats() const -> DescriptorStats {
+  return vulkan_ != nullptr ? vulkan_->descriptor_stats() : DescriptorStats{};
+}
+
+static auto summarize(std::span<float> values) -> TimingSummary {
+  if (values.empty()) return {};
+  std::ranges::sort(values);
+  auto const p99 = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(values.size()))) - 1;
+  return {
+      .min = values.front(),
+      .avg = std::accumulate(values.begin(), values.end(), 0.0f) / static_cast<float>(values.size()),
+      .p99 = values[p99],
+      .max = values.back(),
+  };
+}
+
+auto Window::frame_stats(std::size_t frames) const -> FrameStats {
+  std::vector<FrameTimings> timings(std::min(frames, frame_history_size));
+  timings.resize(frame_timings_.copy_latest(timings));
+
+  FrameStats stats{.frames = timings.size()};
+  std::vector<float> values(timings.size());
+  auto summarize_by = [&](auto&& projection) {
+    std::ranges::transform(timings, values.begin(), projection);
+    return summarize(values);
+  };
+  for (std::size_t i = 0; i < frame_phase_count; ++i) {
+    stats.cpu[i] = summarize_by([i](FrameTimings const& t) { return t.cpu[i]; });
+  }
+  stats.cpu_total = summarize_by(&FrameTimings::cpu_total);
+  stats.gpu = summarize_by(&FrameTimings::gpu);
+
+  values.clear();
+  for (auto const& frame : timings) {
+    if (frame.input_latency <= 0) continue;
+    values.push_back(frame.input_latency);
+    auto const bucket = std::ranges::lower_bound(input_latency_buckets, frame.input_latency);
+    ++stats.input_latency_histogram[static_cast<std::size_t>(bucket - input_latency_buckets.begin())];
+  }
+  stats.input_frames = values.size();
+  stats.input_latency = summarize(values);
+  return stats;
+}
+
+void Window::draw_stats_overlay() {
+  auto const stats = frame_stats();
+
+  constexpr static ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+                                            ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing |
+                                            ImGuiWindowFlags_NoNav;
+  constexpr static float padding = 10.0f;
+  ImGuiViewport const* viewport = ImGui::GetMainViewport();
+  ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - padding, viewport->WorkPos.y + padding),
+                          ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+  ImGui::SetNextWindowBgAlpha(0.35f);
+  if (ImGui::Begin("Frame statistics", nullptr, flags)) {
+    ImGui::Text("GPU: %s", device_info_.name.c_str());
+    ImGui::Text("Last %d frames, ms", static_cast<int>(stats.frames));
+    if (render_scale_policy_.scale < 1 || render_scale_policy_.target_fps > 0) {
+      ImGui::Text("Render scale %.0f%%", static_cast<double>(render_scale() * 100.0f));
+    }
+    if (ImGui::BeginTable("##frame_stats", 5, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg)) {
+      for (auto const* header : {"phase", "min", "avg", "p99", "max"}) { ImGui::TableSetupColumn(header); }
+      ImGui::TableHeadersRow();
+      auto row = [](std::string_view name, TimingSummary const& summary) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name.data(), name.data() + name.size());
+        for (float value : {summary.min, summary.avg, summary.p99, summary.max}) {
+          ImGui::TableNextColumn();
+          ImGui::Text("%.3f", static_cast<double>(value));
+        }
+      };
+      for (std::size_t i = 0; i < frame_phase_count; ++i) {
+        row(frame_phase_name(static_cast<FramePhase>(i)), stats.cpu[i]);
+      }
+      row("CPU total", stats.cpu_total);
+      row("GPU", stats.gpu);
+      if (stats.input_frames > 0) row("input to present", stats.input_latency);
+      ImGui::EndTable();
+    }
+    if (host_allocator_ != nullptr) {
+      auto const memory = host_memory_stats();
+      constexpr static double kib = 1.0 / 1024.0;
+      ImGui::Text("Host memory %.1f KiB live, %.1f KiB peak, %.1f KiB reserved",
+                  static_cast<double>(memory.bytes_live) * kib, static_cast<double>(memory.bytes_peak) * kib,
+                  static_cast<double>(memory.bytes_reserved) * kib);
+      ImGui::Text("%llu allocations last frame", static_cast<unsigned long long>(memory.allocations_last_frame));
+    }
+    auto const descriptors = descriptor_stats();
+    ImGui::Text("Descriptor sets %u live, %u peak, %u capacity in %u pools", descriptors.live, descriptors.peak,
+                descriptors.capacity, descriptors.pools);
+  }
+  ImGui::End();
+}
+
+Application::Application(Window* window) : Application(std::span<Window* const>(&window, 1)) {}
+
+Application::Application(std::span<Window* const> windows) {
+  // Setup SDL
+  if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) [[unlikely]] {
+    throw_gui_error("Failed to initialize SDL2: {}\n", SDL_GetError());
+  }
+  for (auto* window : windows) { add_window(window); }
+}
+
+Application::~Application() noexcept { SDL_Quit(); }
+
+void Application::add_window(Window* window) {
+  if (window != nullptr) { pending_.push_back(window); }
+}
+
+void Application::wait_events(std::vector<SDL_Event>& events) const {
+  auto next = std::chrono::steady_clock::time_point::max();
+  bool idle = true;
+  for (auto const* window : windows_) {
+    next = std::min(next, window->next_draw_time());
+    idle = idle && window->is_idle();
+  }
+
+  SDL_Event event;
+  int has_event = 0;
+  auto const now = std::chrono::steady_clock::now();
+  if (next > now) {
+    if (!idle) {
+      // only the frame limiter is waiting, events are handled with the next frame
+      std::this_thread::sleep_until(next);
+    } else if (next == std::chrono::steady_clock::time_point::max()) {
+      has_event = SDL_WaitEvent(&event);
+    } else {
+      auto const timeout = std::chrono::ceil<std::chrono::milliseconds>(next - now).count();
+      has_event = SDL_WaitEventTimeout(&event, static_cast<int>(timeout));
+    }
+  }
+  if (has_event == 0) { has_event = SDL_PollEvent(&event); }
+  for (; has_event != 0; has_event = SDL_PollEvent(&event)) { events.push_back(event); }
+}
+
+auto Application::run() noexcept -> int {
+  if (windows_.empty() && pending_.empty()) {
+    fmt::print(stderr, "No window given\n");
+    return -3;
+  }
+
+  try {
+    // only the windows keep the device alive, it is released with the last one using it
+    std::weak_ptr<Device> shared_device;
+    scope_guard guard([this]() {
+      for (auto* window : windows_) { window->destroy(); }
+      windows_.clear();
+    });
+
+    std::vector<SDL_Event> events;
+    while (true) {
+      // show windows added since the last iteration, possibly from `on_gui()`
+      while (!pending_.empty()) {
+        auto* window = pending_.front();
+        pending_.erase(pending_.begin());
+        // destroyed by the guard even if creation fails
+        windows_.push_back(window);
+        auto device = shared_device.lock();
+        window->create(device);
+        shared_device = device;
+      }
+      if (windows_.empty()) { break; }
+
+      // low latency windows wait for their GPU work here so that the events are as fresh as possible
+      for (auto* window : windows_) { window->wait_for_frame(); }
+      events.clear();
+      wait_events(events);
+      for (auto* window : windows_) { window->draw(events); }
+
+      for (auto it = windows_.begin(); it != windows_.end();) {
+        if ((*it)->is_running()) {
+          ++it;
+        } else {
+          (*it)->destroy();
+          it = windows_.erase(it);
+        }
+      }
+    }
+    return 0;
+  } catch (GUIError const& e) {
+    fmt::print("{:s}({:d}) in {:s}:\n\t{:s}\n", e.source().file_name(), e.source().line(), e.source().function_name(),
+               e.what());
+    return e.error();
+  } catch (std::exception const& e) {
+    fmt::print("Exception caught: {:s}\n", e.what());
+    return -1;
+  } catch (...) {
+    fmt::print(stderr, "Unknown thrown object!\n");
+    return -2;
+  }
+}
+
+IMGUI_VK_NAMESPACE_END